@@ -6,7 +6,16 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../common/threads.cpp"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 // VIQR
 #define TRANG	'('
@@ -18,92 +27,80 @@
 #define NGA		'~'
 #define NANG	'.'
 
-int laDauMu(char c)
+// Mau 5 ky tu cua chu c (da co dau mu, dau thanh) o dong thu dong (1..14)
+constexpr const char *mauChu(char c, char mu, char thanh, int dong)
 {
-	if(c == MU || c == TRANG || c == RAU)
-		return 1;
-	return 0;
-}
-
-int laDauThanh(char c)
-{
-	if(c == SAC || c == HUYEN || c == HOI || c == NGA || c == NANG)
-		return 1;
-	return 0;
-}
-
-void xuatChu(char c, char mu, char thanh, int dong)
-{
-	c = toupper(c);
+	if(c >= 'a' && c <= 'z')
+		c = c - 'a' + 'A';
 	
 	if(dong == 1)
 	{
 		if(thanh == HOI)
-			printf("  _  ");
+			return "  _  ";
 		else
-			printf("     ");
+			return "     ";
 	}
 	else if(dong == 2)
 	{
 		if(thanh == SAC)
-			printf("    /");
+			return "    /";
 		else if(thanh == HUYEN)
-			printf("   \\ ");
+			return "   \\ ";
 		else if(thanh == HOI)
-			printf(" / \xdd ");
+			return " / \xdd ";
 		else if(thanh == NGA)
-			printf(" __/ ");
+			return " __/ ";
 		else
-			printf("     ");
+			return "     ";
 	}
 	else if(dong == 3)
 	{
 		if(thanh == SAC)
-			printf("   / ");
+			return "   / ";
 		else if(thanh == HUYEN)
-			printf("    \\");
+			return "    \\";
 		else if(thanh == HOI)
-			printf("   \xdd ");
+			return "   \xdd ";
 		else if(thanh == NGA)
-			printf("/    ");
+			return "/    ";
 		else
-			printf("     ");
+			return "     ";
 	}
 	else if(dong == 4)
 	{
 		if(mu == MU)
-			printf(" /\\  ");
+			return " /\\  ";
 		else if(mu == TRANG)
-			printf("\\  / ");
+			return "\\  / ";
 		else if(mu == RAU)
-			printf("   __");
+			return "   __";
 		else
-			printf("     ");
+			return "     ";
 	}
 	else if(dong == 5)
 	{
 		if(mu == MU)
-			printf("/  \\ ");
+			return "/  \\ ";
 		else if(mu == TRANG)
-			printf(" \\/  ");
+			return " \\/  ";
 		else if(mu == RAU)
-			printf("  / \xde");
+			return "  / \xde";
 		else
-			printf("     ");
+			return "     ";
 	}
 	else if(dong == 6)
 	{
 		if(mu == RAU)
 		{
 			if(c == 'O')
-				printf(" ___/");
+				return " ___/";
 			else
-				printf("    /");
+				return "    /";
 		}
 		else if(c == 'O' || c == 'Q' || c == 'C' || c == 'G')
-			printf(" ___ ");
+			return " ___ ";
 		else
-			printf("     ");
+			return "     ";
 	}
 	else if(dong <= 13)
 	{
@@ -111,194 +108,669 @@ void xuatChu(char c, char mu, char thanh, int dong)
 		{
 			switch(dong)
 			{
-				case 7: printf("  /\\ "); break;
-				case 8: printf(" /  \\"); break;
-				case 9: printf("/   \xde"); break;
-				case 10: printf("\xdd___\xde"); break;
-				case 11: printf("\xdd   \xde"); break;
-				case 12: printf("\xdd   \xde"); break;
-				case 13: printf("\xdd   \xde"); break;
+				case 7: return "  /\\ "; 
+				case 8: return " /  \\"; 
+				case 9: return "/   \xde"; 
+				case 10: return "\xdd___\xde"; 
+				case 11: return "\xdd   \xde"; 
+				case 12: return "\xdd   \xde"; 
+				case 13: return "\xdd   \xde"; 
 			}
 		}
 		else if(c == 'C')
 		{
 			switch(dong)
 			{
-				case 7: printf("/   \\"); break;
-				case 8: printf("\xdd    "); break;
-				case 9: printf("\xdd    "); break;
-				case 10: printf("\xdd    "); break;
-				case 11: printf("\xdd    "); break;
-				case 12: printf("\xdd    "); break;
-				case 13: printf("\\___/"); break;
+				case 7: return "/   \\"; 
+				case 8: return "\xdd    "; 
+				case 9: return "\xdd    "; 
+				case 10: return "\xdd    "; 
+				case 11: return "\xdd    "; 
+				case 12: return "\xdd    "; 
+				case 13: return "\\___/"; 
 			}
 		}
 		else if(c == 'G')
 		{
 			switch(dong)
 			{
-				case 7: printf("/   \\"); break;
-				case 8: printf("\xdd    "); break;
-				case 9: printf("\xdd    "); break;
-				case 10: printf("\xdd ___"); break;
-				case 11: printf("\xdd   \xde"); break;
-				case 12: printf("\xdd   \xde"); break;
-				case 13: printf("\\___/"); break;
+				case 7: return "/   \\"; 
+				case 8: return "\xdd    "; 
+				case 9: return "\xdd    "; 
+				case 10: return "\xdd ___"; 
+				case 11: return "\xdd   \xde"; 
+				case 12: return "\xdd   \xde"; 
+				case 13: return "\\___/"; 
 			}
 		}
 		else if(c == 'H')
 		{
 			switch(dong)
 			{
-				case 7: printf("\xdd   \xde"); break;
-				case 8: printf("\xdd   \xde"); break;
-				case 9: printf("\xdd   \xde"); break;
-				case 10: printf("\xdd___\xde"); break;
-				case 11: printf("\xdd   \xde"); break;
-				case 12: printf("\xdd   \xde"); break;
-				case 13: printf("\xdd   \xde"); break;
+				case 7: return "\xdd   \xde"; 
+				case 8: return "\xdd   \xde"; 
+				case 9: return "\xdd   \xde"; 
+				case 10: return "\xdd___\xde"; 
+				case 11: return "\xdd   \xde"; 
+				case 12: return "\xdd   \xde"; 
+				case 13: return "\xdd   \xde"; 
 			}
 		}
 		else if(c == 'M')
 		{
 			switch(dong)
 			{
-				case 7: printf("\\   /"); break;
-				case 8: printf("\xdd\\_/\xde"); break;
-				case 9: printf("\xdd   \xde"); break;
-				case 10: printf("\xdd   \xde"); break;
-				case 11: printf("\xdd   \xde"); break;
-				case 12: printf("\xdd   \xde"); break;
-				case 13: printf("\xdd   \xde"); break;
+				case 7: return "\\   /"; 
+				case 8: return "\xdd\\_/\xde"; 
+				case 9: return "\xdd   \xde"; 
+				case 10: return "\xdd   \xde"; 
+				case 11: return "\xdd   \xde"; 
+				case 12: return "\xdd   \xde"; 
+				case 13: return "\xdd   \xde"; 
 			}
 		}
 		else if(c == 'N')
 		{
 			switch(dong)
 			{
-				case 7: printf("\\   \xde"); break;
-				case 8: printf("\xdd\\  \xde"); break;
-				case 9: printf("\xdd \\ \xde"); break;
-				case 10: printf("\xdd  \\\xde"); break;
-				case 11: printf("\xdd   \xde"); break;
-				case 12: printf("\xdd   \xde"); break;
-				case 13: printf("\xdd   \xde"); break;
+				case 7: return "\\   \xde"; 
+				case 8: return "\xdd\\  \xde"; 
+				case 9: return "\xdd \\ \xde"; 
+				case 10: return "\xdd  \\\xde"; 
+				case 11: return "\xdd   \xde"; 
+				case 12: return "\xdd   \xde"; 
+				case 13: return "\xdd   \xde"; 
 			}
 		}
 		else if(c == 'O')
 		{
 			switch(dong)
 			{
-				case 7: printf("/   \\"); break;
-				case 8: printf("\xdd   \xde"); break;
-				case 9: printf("\xdd   \xde"); break;
-				case 10: printf("\xdd   \xde"); break;
-				case 11: printf("\xdd   \xde"); break;
-				case 12: printf("\xdd   \xde"); break;
-				case 13: printf("\\___/"); break;
+				case 7: return "/   \\"; 
+				case 8: return "\xdd   \xde"; 
+				case 9: return "\xdd   \xde"; 
+				case 10: return "\xdd   \xde"; 
+				case 11: return "\xdd   \xde"; 
+				case 12: return "\xdd   \xde"; 
+				case 13: return "\\___/"; 
 			}
 		}
 		else if(c == 'Q')
 		{
 			switch(dong)
 			{
-				case 7: printf("/   \\"); break;
-				case 8: printf("\xdd   \xde"); break;
-				case 9: printf("\xdd   \xde"); break;
-				case 10: printf("\xdd   \xde"); break;
-				case 11: printf("\xdd   \xde"); break;
-				case 12: printf("\xdd  \\/"); break;
-				case 13: printf("\\__/\\"); break;
+				case 7: return "/   \\"; 
+				case 8: return "\xdd   \xde"; 
+				case 9: return "\xdd   \xde"; 
+				case 10: return "\xdd   \xde"; 
+				case 11: return "\xdd   \xde"; 
+				case 12: return "\xdd  \\/"; 
+				case 13: return "\\__/\\"; 
 			}
 		}
 		else if(c == 'V')
 		{
 			switch(dong)
 			{
-				case 7: printf("\xdd   \xde"); break;
-				case 8: printf("\xdd   \xde"); break;
-				case 9: printf("\xdd   \xde"); break;
-				case 10: printf("\xdd   \xde"); break;
-				case 11: printf("\xdd   /"); break;
-				case 12: printf("\\  / "); break;
-				case 13: printf(" \\/  "); break;
+				case 7: return "\xdd   \xde"; 
+				case 8: return "\xdd   \xde"; 
+				case 9: return "\xdd   \xde"; 
+				case 10: return "\xdd   \xde"; 
+				case 11: return "\xdd   /"; 
+				case 12: return "\\  / "; 
+				case 13: return " \\/  "; 
 			}
 		}
 		else if(c == 'U')
 		{
 			switch(dong)
 			{
-				case 7: printf("\xdd   \xde"); break;
-				case 8: printf("\xdd   \xde"); break;
-				case 9: printf("\xdd   \xde"); break;
-				case 10: printf("\xdd   \xde"); break;
-				case 11: printf("\xdd   \xde"); break;
-				case 12: printf("\xdd   \xde"); break;
-				case 13: printf("\\___/"); break;
+				case 7: return "\xdd   \xde"; 
+				case 8: return "\xdd   \xde"; 
+				case 9: return "\xdd   \xde"; 
+				case 10: return "\xdd   \xde"; 
+				case 11: return "\xdd   \xde"; 
+				case 12: return "\xdd   \xde"; 
+				case 13: return "\\___/"; 
 			}
 		}
 		else if(c == ' ')
-			printf("     ");
+			return "     ";
 		else
-			printf("#####");
+			return "#####";
 	}
 	else if(dong == 14)
 	{
 		if(thanh == '.')
-			printf("  _  ");
+			return "  _  ";
 		else
-			printf("     ");
+			return "     ";
+	}
+	return "";
+}
+
+// ---------------------------------------------------------------------------
+// Ban nhanh: bang hinh chu (atlas) tinh san luc bien dich.
+// Moi chu sau khi phan tich la mot so hieu hinh (chu x mu x thanh), moi dong
+// cua hinh la 5 byte trong ATLAS. Chuoi chi phan tich mot lan, 14 dong duoc
+// ghep bang memcpy vao mot bo dem roi ghi ra mot lan.
+
+#define SO_CHU		12	// ' ', A C G H M N O Q U V va "chu khac" (#####)
+#define SO_MU		4	// khong, ^, (, +
+#define SO_THANH	6	// khong, ', `, ?, ~, .
+#define SO_DONG		14
+#define SO_HINH		(SO_CHU * SO_MU * SO_THANH)
+#define RONG_CHU	6	// 5 ky tu hinh + 1 khoang cach
+
+constexpr char CAC_CHU[SO_CHU] = {' ', 'A', 'C', 'G', 'H', 'M', 'N', 'O', 'Q', 'U', 'V', '#'};
+constexpr char CAC_MU[SO_MU] = {0, MU, TRANG, RAU};
+constexpr char CAC_THANH[SO_THANH] = {0, SAC, HUYEN, HOI, NGA, NANG};
+
+typedef unsigned short SoHieuHinh;
+
+struct Atlas
+{
+	char hinh[SO_HINH][SO_DONG][5];
+	unsigned char lopChu[256];		// ky tu -> chi so trong CAC_CHU
+	unsigned char lopMu[256];		// ky tu -> chi so trong CAC_MU (0 neu khong phai dau mu)
+	unsigned char lopThanh[256];	// ky tu -> chi so trong CAC_THANH (0 neu khong phai dau thanh)
+};
+
+constexpr Atlas taoAtlas()
+{
+	Atlas a{};
+	for(int chu = 0; chu < SO_CHU; chu++)
+		for(int mu = 0; mu < SO_MU; mu++)
+			for(int thanh = 0; thanh < SO_THANH; thanh++)
+				for(int dong = 1; dong <= SO_DONG; dong++)
+				{
+					const char *mau = mauChu(CAC_CHU[chu], CAC_MU[mu], CAC_THANH[thanh], dong);
+					for(int k = 0; k < 5; k++)
+						a.hinh[(chu * SO_MU + mu) * SO_THANH + thanh][dong - 1][k] = mau[k];
+				}
+
+	for(int c = 0; c < 256; c++)
+	{
+		char hoa = (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+		a.lopChu[c] = SO_CHU - 1;
+		for(int chu = 0; chu < SO_CHU - 1; chu++)
+			if(CAC_CHU[chu] == hoa)
+				a.lopChu[c] = chu;
+		for(int mu = 1; mu < SO_MU; mu++)
+			if(CAC_MU[mu] == c)
+				a.lopMu[c] = mu;
+		for(int thanh = 1; thanh < SO_THANH; thanh++)
+			if(CAC_THANH[thanh] == c)
+				a.lopThanh[c] = thanh;
 	}
+	return a;
 }
 
-void xuatChuoi(const char chuoi[])
+constexpr Atlas ATLAS = taoAtlas();
+
+constexpr SoHieuHinh soHieuHinh(int chu, int mu, int thanh)
 {
-	for(int dong = 1; dong <= 14; dong++)
+	return (chu * SO_MU + mu) * SO_THANH + thanh;
+}
+
+// Phan tich chuoi VIQR thanh day so hieu hinh: chu, roi dau mu va dau thanh
+// neu co (vd A^' la mot chu).
+// Tra ve so chu; hinh[] phai chua duoc it nhat strlen(chuoi) phan tu.
+int phanTich(const char chuoi[], SoHieuHinh hinh[])
+{
+	int n = 0, i = 0;
+	while(chuoi[i] != '\0' && chuoi[i] != '\n')
 	{
-		int i = 0;
-		while(chuoi[i] != '\0' && chuoi[i] != '\n')
+		int chu = ATLAS.lopChu[(unsigned char)chuoi[i]];
+		int mu = ATLAS.lopMu[(unsigned char)chuoi[i + 1]];
+		int thanh = 0;
+		if(mu)
 		{
-			if(laDauThanh(chuoi[i + 1]))
-			{
+			thanh = ATLAS.lopThanh[(unsigned char)chuoi[i + 2]];
+			i += thanh ? 3 : 2;
+		}
+		else
+		{
+			thanh = ATLAS.lopThanh[(unsigned char)chuoi[i + 1]];
+			i += thanh ? 2 : 1;
+		}
+		hinh[n++] = soHieuHinh(chu, mu, thanh);
+	}
+	return n;
+}
 
-				xuatChu(chuoi[i], 0, chuoi[i + 1], dong);
-				i += 2;
-			}
-			else if(laDauMu(chuoi[i + 1]))
+// So byte can de ve n chu
+size_t kichThuocBanVe(int n)
+{
+	return (size_t)SO_DONG * (n * RONG_CHU + 1);
+}
+
+// Ghep 14 dong cua n chu vao ra[] (kich thuoc kichThuocBanVe(n)), tra ve so byte
+size_t veChuoi(const SoHieuHinh hinh[], int n, char ra[])
+{
+	char *p = ra;
+	for(int dong = 0; dong < SO_DONG; dong++)
+	{
+		for(int k = 0; k < n; k++)
+		{
+			memcpy(p, ATLAS.hinh[hinh[k]][dong], 5);
+			p[5] = ' ';	// khoang cach chu: 1 SPACE
+			p += RONG_CHU;
+		}
+		*p++ = '\n';
+	}
+	return p - ra;
+}
+
+// ---------------------------------------------------------------------------
+// Nhap UTF-8: chu tieng Viet dung san (precomposed) nhu "VŨ QUỐC HOÀNG".
+// Moi ma Unicode duoc tra bang thang ra so hieu hinh (chu, mu, thanh), khong
+// can doi sang VIQR truoc. Ky tu ASCII giu nguyen nghia (dau ' ` ? ~ . ^ ( +
+// la ky tu thuong), doan ASCII dai duoc kiem tra 16 byte mot lan bang SSE2.
+// Dau to hop rieng (dang NFD) duoc gan vao chu dung truoc.
+
+#define MA_TOI_DA	0x1F00	// ma lon nhat cua chu tieng Viet la U+1EF9
+
+struct NguyenAm
+{
+	char chu, mu;
+	unsigned short ma[SO_THANH];	// chu thuong: khong dau, sac, huyen, hoi, nga, nang
+};
+
+constexpr NguyenAm NGUYEN_AM[] = {
+	{'A', 0,     {0x61, 0xE1, 0xE0, 0x1EA3, 0xE3, 0x1EA1}},
+	{'A', TRANG, {0x103, 0x1EAF, 0x1EB1, 0x1EB3, 0x1EB5, 0x1EB7}},
+	{'A', MU,    {0xE2, 0x1EA5, 0x1EA7, 0x1EA9, 0x1EAB, 0x1EAD}},
+	{'E', 0,     {0x65, 0xE9, 0xE8, 0x1EBB, 0x1EBD, 0x1EB9}},
+	{'E', MU,    {0xEA, 0x1EBF, 0x1EC1, 0x1EC3, 0x1EC5, 0x1EC7}},
+	{'I', 0,     {0x69, 0xED, 0xEC, 0x1EC9, 0x129, 0x1ECB}},
+	{'O', 0,     {0x6F, 0xF3, 0xF2, 0x1ECF, 0xF5, 0x1ECD}},
+	{'O', MU,    {0xF4, 0x1ED1, 0x1ED3, 0x1ED5, 0x1ED7, 0x1ED9}},
+	{'O', RAU,   {0x1A1, 0x1EDB, 0x1EDD, 0x1EDF, 0x1EE1, 0x1EE3}},
+	{'U', 0,     {0x75, 0xFA, 0xF9, 0x1EE7, 0x169, 0x1EE5}},
+	{'U', RAU,   {0x1B0, 0x1EE9, 0x1EEB, 0x1EED, 0x1EEF, 0x1EF1}},
+	{'Y', 0,     {0x79, 0xFD, 0x1EF3, 0x1EF7, 0x1EF9, 0x1EF5}},
+};
+
+// Ma chu hoa tuong ung voi ma chu thuong trong NGUYEN_AM
+constexpr unsigned chuHoa(unsigned ma)
+{
+	if(ma < 0x100)
+		return ma - 0x20;
+	return ma - 1;	// U+0103, 0129, 0169, 01A1, 01B0 va day U+1Exx: chu hoa dung ngay truoc
+}
+
+constexpr int chiSo(const char bang[], int n, char c)
+{
+	for(int i = 0; i < n; i++)
+		if(bang[i] == c)
+			return i;
+	return 0;
+}
+
+struct BangUtf8
+{
+	SoHieuHinh hinh[MA_TOI_DA];	// ma Unicode -> so hieu hinh
+};
+
+constexpr BangUtf8 taoBangUtf8()
+{
+	BangUtf8 b{};
+	for(int ma = 0; ma < MA_TOI_DA; ma++)
+		b.hinh[ma] = soHieuHinh(ma < 128 ? ATLAS.lopChu[ma] : SO_CHU - 1, 0, 0);
+	for(const NguyenAm &v : NGUYEN_AM)
+	{
+		int chu = ATLAS.lopChu[(unsigned char)v.chu];
+		int mu = chiSo(CAC_MU, SO_MU, v.mu);
+		for(int thanh = 0; thanh < SO_THANH; thanh++)
+		{
+			b.hinh[v.ma[thanh]] = soHieuHinh(chu, mu, thanh);
+			b.hinh[chuHoa(v.ma[thanh])] = soHieuHinh(chu, mu, thanh);
+		}
+	}
+	b.hinh[0x110] = b.hinh[0x111] = soHieuHinh(ATLAS.lopChu['D'], 0, 0);	// Đ, đ
+	return b;
+}
+
+constexpr BangUtf8 BANG_UTF8 = taoBangUtf8();
+
+// Dau to hop (dang NFD: chu goc + dau rieng). Tra ve 1 neu ma la dau mu
+// (*mu = chi so trong CAC_MU) hoac dau thanh (*thanh = chi so trong CAC_THANH).
+int dauToHop(unsigned ma, int *mu, int *thanh)
+{
+	*mu = *thanh = 0;
+	switch(ma)
+	{
+		case 0x302: *mu = 1; break;		// mu ^
+		case 0x306: *mu = 2; break;		// trang (
+		case 0x31B: *mu = 3; break;		// rau +
+		case 0x301: *thanh = 1; break;	// sac
+		case 0x300: *thanh = 2; break;	// huyen
+		case 0x309: *thanh = 3; break;	// hoi
+		case 0x303: *thanh = 4; break;	// nga
+		case 0x323: *thanh = 5; break;	// nang
+		default: return 0;
+	}
+	return 1;
+}
+
+// Giai ma mot ma UTF-8 bat dau tai s[i] (i < dai), tra ve so byte da dung.
+// Chuoi byte sai quy tac duoc tinh la mot ky tu la (1 byte).
+int giaiMaUtf8(const unsigned char s[], size_t i, size_t dai, unsigned *ma)
+{
+	unsigned c = s[i];
+	int n = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 0;
+	if(n == 0 || i + n > dai)
+	{
+		*ma = MA_TOI_DA;
+		return 1;
+	}
+	unsigned kq = c & (0x7F >> n);
+	for(int k = 1; k < n; k++)
+	{
+		if((s[i + k] & 0xC0) != 0x80)
+		{
+			*ma = MA_TOI_DA;
+			return 1;
+		}
+		kq = kq << 6 | (s[i + k] & 0x3F);
+	}
+	*ma = kq;
+	return n;
+}
+
+// Phan tich dai byte UTF-8 thanh day so hieu hinh, tra ve so chu.
+// hinh[] phai chua duoc it nhat dai phan tu.
+int phanTichUtf8(const char chuoi[], size_t dai, SoHieuHinh hinh[])
+{
+	const unsigned char *s = (const unsigned char *)chuoi;
+	int n = 0;
+	size_t i = 0;
+	while(i < dai)
+	{
+#ifdef __SSE2__
+		// 16 byte deu < 0x80 (bit cao bang 0): tra bang ASCII lien mot mach
+		while(i + 16 <= dai &&
+			_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(s + i))) == 0)
+		{
+			for(int k = 0; k < 16; k++)
+				hinh[n + k] = BANG_UTF8.hinh[s[i + k]];
+			n += 16;
+			i += 16;
+		}
+		if(i >= dai)
+			break;
+#endif
+		if(s[i] < 0x80)
+		{
+			hinh[n++] = BANG_UTF8.hinh[s[i++]];
+			continue;
+		}
+		unsigned ma;
+		i += giaiMaUtf8(s, i, dai, &ma);
+		int mu, thanh;
+		if(dauToHop(ma, &mu, &thanh) && n > 0)
+		{
+			// gan dau vao chu dung truoc neu chu do chua co dau cung loai
+			int truoc = hinh[n - 1];
+			if(mu && truoc / SO_THANH % SO_MU == 0)
 			{
-				if(laDauThanh(chuoi[i + 2]))
-				{
-					xuatChu(chuoi[i], chuoi[i + 1], chuoi[i + 2], dong);
-					i += 3;
-				}
-				else
-				{
-					xuatChu(chuoi[i], chuoi[i + 1], 0, dong);
-					i += 2;
-				}
+				hinh[n - 1] = truoc + mu * SO_THANH;
+				continue;
 			}
-			else
+			if(thanh && truoc % SO_THANH == 0)
 			{
-
-				xuatChu(chuoi[i], 0, 0, dong);
-				i++;
+				hinh[n - 1] = truoc + thanh;
+				continue;
 			}
+		}
+		hinh[n++] = ma < MA_TOI_DA ? BANG_UTF8.hinh[ma] : soHieuHinh(SO_CHU - 1, 0, 0);
+	}
+	return n;
+}
+
+void xuatChuoiNhanh(const char chuoi[], bool utf8 = false)
+{
+	size_t dai = strlen(chuoi);
+	SoHieuHinh *hinh = (SoHieuHinh *)malloc((dai + 1) * sizeof(SoHieuHinh));
+	int n;
+	if(utf8)
+		n = phanTichUtf8(chuoi, strcspn(chuoi, "\r\n"), hinh);
+	else
+		n = phanTich(chuoi, hinh);
+	char *ra = (char *)malloc(kichThuocBanVe(n));
+	size_t soByte = veChuoi(hinh, n, ra);
+	fwrite(ra, 1, soByte, stdout);
+	fflush(stdout);
+	free(ra);
+	free(hinh);
+}
+
+// ---------------------------------------------------------------------------
+// Che do tep: ve tung dong cua ca mot tep van ban.
+// Doc tung khoi lon (KHOI_DOC byte), tach dong ngay trong bo dem (khong chep
+// ra chuoi rieng), cac dong cua mot khoi duoc chia deu cho cac thread, moi
+// thread ve vao bo dem rieng cua no; sau do ghi cac bo dem theo thu tu thread
+// nen thu tu dong giu nguyen nhu trong tep.
+
+#define KHOI_DOC	(1 << 22)
 
-			printf(" ");	// khoang cach chu: 1 SPACE
+struct BoDem
+{
+	char *du_lieu;
+	size_t dai, sucChua;
+};
+
+void damBao(BoDem *b, size_t them)
+{
+	if(b->dai + them <= b->sucChua)
+		return;
+	size_t moi = b->sucChua ? b->sucChua : 1 << 16;
+	while(moi < b->dai + them)
+		moi *= 2;
+	b->du_lieu = (char *)realloc(b->du_lieu, moi);
+	b->sucChua = moi;
+}
+
+// Ve cac dong dong[dau..cuoi) vao b; hinh[] la bo dem tam (do dai >= dong dai nhat + 1)
+void veCacDong(char *const dong[], const size_t doDai[], long dau, long cuoi,
+	bool utf8, BoDem *b, std::vector<SoHieuHinh> *hinh)
+{
+	b->dai = 0;
+	for(long i = dau; i < cuoi; i++)
+	{
+		if(hinh->size() < doDai[i] + 1)
+			hinh->resize(doDai[i] + 1);
+		int n = utf8 ? phanTichUtf8(dong[i], doDai[i], hinh->data())
+			: phanTich(dong[i], hinh->data());
+		damBao(b, kichThuocBanVe(n));
+		b->dai += veChuoi(hinh->data(), n, b->du_lieu + b->dai);
+	}
+}
+
+// Tach khoi[0..dai) thanh cac dong tai cho: thay '\n' (va '\r' cua CRLF) bang
+// '\0'; do dai moi dong khong tinh '\r'. Tra ve vi tri sau '\n' cuoi cung.
+size_t tachDong(char khoi[], size_t dai, std::vector<char *> *dong, std::vector<size_t> *doDai)
+{
+	dong->clear();
+	doDai->clear();
+	size_t batDau = 0;
+	for(;;)
+	{
+		char *xuong = (char *)memchr(khoi + batDau, '\n', dai - batDau);
+		if(!xuong)
+			break;
+		size_t ket = xuong - khoi;
+		*xuong = '\0';
+		if(ket > batDau && khoi[ket - 1] == '\r')
+			khoi[--ket] = '\0';
+		dong->push_back(khoi + batDau);
+		doDai->push_back(ket - batDau);
+		batDau = xuong - khoi + 1;
+	}
+	return batDau;
+}
+
+// Ve tep vao (NULL = stdin) ra tep ra (NULL = stdout), tra ve so dong, -1 neu loi.
+// utf8: tep la UTF-8 (phanTichUtf8), nguoc lai la VIQR.
+long xuatTep(const char *tenVao, const char *tenRa, int soThread, bool utf8)
+{
+	FILE *vao = tenVao ? fopen(tenVao, "rb") : stdin;
+	if(!vao)
+		return -1;
+	FILE *ra = tenRa ? fopen(tenRa, "wb") : stdout;
+	if(!ra)
+	{
+		if(tenVao)
+			fclose(vao);
+		return -1;
+	}
+	if(soThread < 1)
+		soThread = 1;
+
+	size_t sucChua = KHOI_DOC, conLai = 0;
+	char *khoi = (char *)malloc(sucChua + 1);
+	std::vector<char *> dong;
+	std::vector<size_t> doDai;
+	std::vector<BoDem> boDem(soThread, BoDem{NULL, 0, 0});
+	std::vector<std::vector<SoHieuHinh> > hinh(soThread);
+	long tongDong = 0;
+	bool het = false;
+
+	while(!het)
+	{
+		// phan con lai cua khoi truoc (dong chua co '\n') da nam o dau bo dem
+		if(conLai == sucChua)
+		{
+			// mot dong dai hon ca bo dem: noi rong bo dem
+			sucChua *= 2;
+			khoi = (char *)realloc(khoi, sucChua + 1);
+		}
+		size_t doc = fread(khoi + conLai, 1, sucChua - conLai, vao);
+		size_t dai = conLai + doc;
+		if(doc == 0)
+		{
+			het = true;
+			if(dai == 0)
+				break;
+			khoi[dai++] = '\n';	// dong cuoi khong co '\n'
 		}
-		printf("\n");
+
+		size_t batDau = tachDong(khoi, dai, &dong, &doDai);
+
+		long soDong = dong.size();
+		int dung = soDong < soThread * 64 ? 1 : soThread;	// it dong thi khong can thread
+		std::vector<std::thread> tho;
+		for(int t = 1; t < dung; t++)
+			tho.emplace_back(veCacDong, dong.data(), doDai.data(), soDong * t / dung,
+				soDong * (t + 1) / dung, utf8, &boDem[t], &hinh[t]);
+		veCacDong(dong.data(), doDai.data(), 0, soDong / dung, utf8, &boDem[0], &hinh[0]);
+		for(size_t t = 0; t < tho.size(); t++)
+			tho[t].join();
+		for(int t = 0; t < dung; t++)
+			fwrite(boDem[t].du_lieu, 1, boDem[t].dai, ra);
+		tongDong += soDong;
+
+		conLai = dai - batDau;
+		memmove(khoi, khoi + batDau, conLai);
 	}
+
+	for(int t = 0; t < soThread; t++)
+		free(boDem[t].du_lieu);
+	free(khoi);
+	if(tenVao)
+		fclose(vao);
+	if(tenRa)
+		fclose(ra);
+	else
+		fflush(ra);
+	return tongDong;
 }
 
-int main()
+// Kiem tra tach dong: cung mot ten viet theo VIQR / UTF-8, ket thuc bang LF /
+// CRLF, phai ve ra cung mot ket qua. Tra ve so cap khong khop.
+int kiemTraDong()
 {
+	const char *mau[] = {
+		"VU~ QUO^'C\n", "VU~ QUO^'C\r\n",
+		"V\xC5\xA8 QU\xE1\xBB\x90" "C\n", "V\xC5\xA8 QU\xE1\xBB\x90" "C\r\n",
+	};
+	std::vector<char *> dong;
+	std::vector<size_t> doDai;
+	std::vector<SoHieuHinh> hinh;
+	BoDem b[4] = {};
+	for(int k = 0; k < 4; k++)
+	{
+		char khoi[32];
+		size_t dai = strlen(mau[k]);
+		memcpy(khoi, mau[k], dai);
+		tachDong(khoi, dai, &dong, &doDai);
+		veCacDong(dong.data(), doDai.data(), 0, dong.size(), k >= 2, &b[k], &hinh);
+	}
+	int sai = 0;
+	for(int k = 1; k < 4; k++)
+		if(b[k].dai != b[0].dai || memcmp(b[k].du_lieu, b[0].du_lieu, b[0].dai) != 0)
+		{
+			fprintf(stderr, "Sai: %s", mau[k]);
+			sai++;
+		}
+	for(int k = 0; k < 4; k++)
+		free(b[k].du_lieu);
+	return sai;
+}
+
+// Cach dung:
+//   Bai 2.7                            hoi ten roi chao
+//   Bai 2.7 [-u] <tep vao> [tep ra] [so thread]
+//   Bai 2.7 -k                         kiem tra tach dong LF / CRLF
+// Tep vao / tep ra la "-" thi dung stdin / stdout; -u: tep vao la UTF-8.
+// Khi hoi ten, chuoi nhap co byte >= 0x80 thi duoc doc theo UTF-8.
+int main(int argc, char *argv[])
+{
+	if(argc == 2 && strcmp(argv[1], "-k") == 0)
+	{
+		int sai = kiemTraDong();
+		fprintf(stderr, "kiem tra dong: %d sai\n", sai);
+		return sai ? 1 : 0;
+	}
+	bool utf8 = argc >= 2 && strcmp(argv[1], "-u") == 0;
+	if(utf8)
+	{
+		argv++;
+		argc--;
+	}
+	if(argc >= 2)
+	{
+		const char *tenVao = strcmp(argv[1], "-") == 0 ? NULL : argv[1];
+		const char *tenRa = argc >= 3 && strcmp(argv[2], "-") != 0 ? argv[2] : NULL;
+		int soThread = argc >= 4 ? atoi(argv[3]) : hardwareThreads();
+
+		std::chrono::steady_clock::time_point batDau = std::chrono::steady_clock::now();
+		long soDong = xuatTep(tenVao, tenRa, soThread, utf8);
+		double giay = std::chrono::duration<double>(std::chrono::steady_clock::now() - batDau).count();
+		if(soDong < 0)
+		{
+			fprintf(stderr, "Khong mo duoc tep\n");
+			return 1;
+		}
+		fprintf(stderr, "%ld dong, %.3f s, %.0f dong/s\n", soDong, giay,
+			giay > 0 ? soDong / giay : 0.0);
+		return 0;
+	}
+
 	char ten[100];
 
 	printf("Ban ten gi? ");
-	gets(ten); // Nhap chuoi theo VIQR, chang han VU~ QUO^'C HOA`NG
+	// Nhap chuoi theo VIQR, chang han VU~ QUO^'C HOA`NG
+	if(!fgets(ten, sizeof(ten), stdin))
+		ten[0] = '\0';
+	
+	for(int i = 0; ten[i]; i++)
+		if((unsigned char)ten[i] >= 0x80)
+			utf8 = true;
 	
-	xuatChuoi("CHA`O");
-	xuatChuoi(ten);
+	xuatChuoiNhanh("CHA`O");
+	xuatChuoiNhanh(ten, utf8);
 
 	return 0;
 }
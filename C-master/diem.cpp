@@ -0,0 +1,520 @@
+/*
+// Doc bang diem Diem.csv (MSSV,Diem GK,Diem CK) cho tep rat lon
+// Tep duoc mmap, chia thanh nhieu doan theo ranh gioi dong, moi doan duoc
+// phan tich tren mot thread bang from_chars, ket qua luu theo cot.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "../common/threads.cpp"
+using namespace std;
+
+// Bang diem luu theo cot: cot nao duoc dung thi chi cot do nam trong cache
+struct BangDiem
+{
+	vector<uint32_t> mssv;
+	vector<float> gk, ck;
+	size_t soDongLoi;	// dong sai dinh dang, bi bo qua
+
+	size_t size() const { return mssv.size(); }
+};
+
+// Dem so dong khong rong trong [p, het)
+size_t demDong(const char *p, const char *het)
+{
+	size_t n = 0;
+	while(p < het)
+	{
+		const char *xuong = (const char *)memchr(p, '\n', het - p);
+		const char *cuoi = xuong ? xuong : het;
+		if(cuoi > p && !(cuoi - p == 1 && *p == '\r'))
+			n++;
+		p = cuoi + 1;
+	}
+	return n;
+}
+
+// Phan tich mot dong "mssv,gk,ck" ket thuc boi '\n' (hoac het), tra ve con tro
+// sau dong; *ok = false neu dong sai dinh dang.
+const char *docDong(const char *p, const char *het, uint32_t *mssv, float *gk, float *ck, bool *ok)
+{
+	const char *xuong = (const char *)memchr(p, '\n', het - p);
+	const char *cuoi = xuong ? xuong : het;
+	const char *tiep = xuong ? xuong + 1 : het;
+	if(cuoi > p && cuoi[-1] == '\r')
+		cuoi--;
+
+	*ok = false;
+	from_chars_result r = from_chars(p, cuoi, *mssv);
+	if(r.ec != errc() || r.ptr == cuoi || *r.ptr != ',')
+		return tiep;
+	r = from_chars(r.ptr + 1, cuoi, *gk);
+	if(r.ec != errc() || r.ptr == cuoi || *r.ptr != ',')
+		return tiep;
+	r = from_chars(r.ptr + 1, cuoi, *ck);
+	if(r.ec != errc() || r.ptr != cuoi)
+		return tiep;
+	*ok = true;
+	return tiep;
+}
+
+// Phan tich doan [p, het) ghi vao cac cot tu vi tri dau; tra ve so dong ghi duoc
+size_t docDoan(const char *p, const char *het, BangDiem *bd, size_t dau, size_t *loi)
+{
+	uint32_t *mssv = bd->mssv.data() + dau;
+	float *gk = bd->gk.data() + dau;
+	float *ck = bd->ck.data() + dau;
+	size_t n = 0;
+	*loi = 0;
+	while(p < het)
+	{
+		if(*p == '\n' || (*p == '\r' && (p + 1 == het || p[1] == '\n')))
+		{
+			p += *p == '\r' ? 2 : 1;	// dong rong
+			continue;
+		}
+		bool ok;
+		p = docDong(p, het, &mssv[n], &gk[n], &ck[n], &ok);
+		if(ok)
+			n++;
+		else
+			(*loi)++;
+	}
+	return n;
+}
+
+// Doc tep CSV vao bd bang soThread thread. Tra ve false neu khong mo/mmap duoc.
+bool docBangDiem(const char *duongDan, BangDiem &bd, int soThread)
+{
+	bd.mssv.clear();
+	bd.gk.clear();
+	bd.ck.clear();
+	bd.soDongLoi = 0;
+
+	int fd = open(duongDan, O_RDONLY);
+	if(fd < 0)
+		return false;
+	struct stat st;
+	if(fstat(fd, &st) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	size_t dai = st.st_size;
+	if(dai == 0)
+	{
+		close(fd);
+		return true;
+	}
+	void *vung = mmap(NULL, dai, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(vung == MAP_FAILED)
+		return false;
+	madvise(vung, dai, MADV_SEQUENTIAL);
+
+	const char *dauTep = (const char *)vung;
+	const char *het = dauTep + dai;
+	const char *p = dauTep;
+	// bo dong tieu de (dong dau khong bat dau bang chu so)
+	if(*p < '0' || *p > '9')
+	{
+		const char *xuong = (const char *)memchr(p, '\n', dai);
+		p = xuong ? xuong + 1 : het;
+	}
+
+	// chia doan deu theo byte roi day ranh gioi toi sau '\n' tiep theo
+	if(soThread < 1)
+		soThread = 1;
+	if((size_t)(het - p) < (1 << 20))
+		soThread = 1;
+	vector<const char *> bien(soThread + 1);
+	bien[0] = p;
+	for(int t = 1; t < soThread; t++)
+	{
+		const char *q = p + (het - p) * t / soThread;
+		if(q < bien[t - 1])
+			q = bien[t - 1];
+		const char *xuong = (const char *)memchr(q, '\n', het - q);
+		bien[t] = xuong ? xuong + 1 : het;
+	}
+	bien[soThread] = het;
+
+	// luot 1: dem dong moi doan de biet vi tri ghi cua tung doan
+	vector<size_t> dem(soThread), batDau(soThread + 1, 0);
+	vector<thread> tho;
+	for(int t = 0; t < soThread; t++)
+		tho.emplace_back([&, t] { dem[t] = demDong(bien[t], bien[t + 1]); });
+	for(size_t t = 0; t < tho.size(); t++)
+		tho[t].join();
+	for(int t = 0; t < soThread; t++)
+		batDau[t + 1] = batDau[t] + dem[t];
+	bd.mssv.resize(batDau[soThread]);
+	bd.gk.resize(batDau[soThread]);
+	bd.ck.resize(batDau[soThread]);
+
+	// luot 2: phan tich song song, moi doan ghi thang vao phan cua no
+	vector<size_t> soDoc(soThread), loi(soThread);
+	tho.clear();
+	for(int t = 0; t < soThread; t++)
+		tho.emplace_back([&, t] { soDoc[t] = docDoan(bien[t], bien[t + 1], &bd, batDau[t], &loi[t]); });
+	for(size_t t = 0; t < tho.size(); t++)
+		tho[t].join();
+	munmap(vung, dai);
+
+	// dong loi lam doan ngan lai: don cac doan sau cho lien nhau
+	size_t n = soDoc[0];
+	for(int t = 1; t < soThread; t++)
+	{
+		if(n != batDau[t])
+		{
+			memmove(&bd.mssv[n], &bd.mssv[batDau[t]], soDoc[t] * sizeof(uint32_t));
+			memmove(&bd.gk[n], &bd.gk[batDau[t]], soDoc[t] * sizeof(float));
+			memmove(&bd.ck[n], &bd.ck[batDau[t]], soDoc[t] * sizeof(float));
+		}
+		n += soDoc[t];
+	}
+	bd.mssv.resize(n);
+	bd.gk.resize(n);
+	bd.ck.resize(n);
+	for(int t = 0; t < soThread; t++)
+		bd.soDongLoi += loi[t];
+	return true;
+}
+
+// ---------------------------------------------------------------------------
+// Thong ke tren cot. Cac vong lap trong chay tren mang lien tuc, khong re
+// nhanh, cong don vao LAN lan (lane) rieng nen trinh bien dich vector hoa
+// duoc ma khong can -ffast-math; moi KHOI phan tu thi don sang double de
+// khong mat do chinh xac. Cac doan chia cho nhieu thread roi gop lai.
+
+// diem tong = (3 * GK + 7 * CK) / 10; chia cho 10 (khong nhan 0.1) de diem
+// tron nhu 5 van ra dung 5 khi so voi DIEM_DAT
+const float TRONG_SO_GK = 3;
+const float TRONG_SO_CK = 7;
+const float DIEM_DAT = 5.0f;
+const int SO_NGAN = 11;			// histogram: ngan i chua diem trong [i, i + 1), ngan 10 la diem 10
+const int LAN = 8;
+const size_t KHOI = 4096;
+
+struct ThongKe
+{
+	size_t n, soDat;
+	double tong, tongBinhPhuong;
+	float nhoNhat, lonNhat;
+	size_t ngan[SO_NGAN];
+
+	double trungBinh() const { return n ? tong / n : 0; }
+	double phuongSai() const { return n ? tongBinhPhuong / n - trungBinh() * trungBinh() : 0; }
+	void gop(const ThongKe &k);
+};
+
+void ThongKe::gop(const ThongKe &k)
+{
+	if(k.n == 0)
+		return;
+	nhoNhat = n ? min(nhoNhat, k.nhoNhat) : k.nhoNhat;
+	lonNhat = n ? max(lonNhat, k.lonNhat) : k.lonNhat;
+	n += k.n;
+	soDat += k.soDat;
+	tong += k.tong;
+	tongBinhPhuong += k.tongBinhPhuong;
+	for(int i = 0; i < SO_NGAN; i++)
+		ngan[i] += k.ngan[i];
+}
+
+// Chay ham(dau, cuoi, t) tren soThread doan deu nhau cua [0, n)
+void chiaDoan(size_t n, int soThread, const function<void(size_t, size_t, int)> &ham)
+{
+	if(soThread < 1 || n < (1 << 16))
+		soThread = 1;
+	vector<thread> tho;
+	for(int t = 1; t < soThread; t++)
+		tho.emplace_back(ham, n * t / soThread, n * (t + 1) / soThread, t);
+	ham(0, n / soThread, 0);
+	for(size_t t = 0; t < tho.size(); t++)
+		tho[t].join();
+}
+
+// tong[i] = (TRONG_SO_GK * gk[i] + TRONG_SO_CK * ck[i]) / 10
+void tinhDiemTong(const float *__restrict gk, const float *__restrict ck,
+	float *__restrict tong, size_t n, int soThread)
+{
+	chiaDoan(n, soThread, [=](size_t dau, size_t cuoi, int) {
+		for(size_t i = dau; i < cuoi; i++)
+			tong[i] = (TRONG_SO_GK * gk[i] + TRONG_SO_CK * ck[i]) / 10;
+	});
+}
+
+ThongKe thongKeDoan(const float *__restrict x, size_t n)
+{
+	ThongKe k = {};
+	k.n = n;
+	if(n == 0)
+		return k;
+	float nho[LAN], lon[LAN];
+	for(int l = 0; l < LAN; l++)
+		nho[l] = lon[l] = x[0];
+
+	for(size_t khoi = 0; khoi < n; khoi += KHOI)
+	{
+		size_t het = min(n, khoi + KHOI);
+		size_t i = khoi;
+		float s[LAN] = {}, s2[LAN] = {};
+		int dat[LAN] = {};
+		for(; i + LAN <= het; i += LAN)
+			for(int l = 0; l < LAN; l++)
+			{
+				float v = x[i + l];
+				s[l] += v;
+				s2[l] += v * v;
+				dat[l] += v >= DIEM_DAT;
+				nho[l] = v < nho[l] ? v : nho[l];
+				lon[l] = v > lon[l] ? v : lon[l];
+			}
+		for(; i < het; i++)
+		{
+			float v = x[i];
+			s[0] += v;
+			s2[0] += v * v;
+			dat[0] += v >= DIEM_DAT;
+			nho[0] = v < nho[0] ? v : nho[0];
+			lon[0] = v > lon[0] ? v : lon[0];
+		}
+		for(int l = 0; l < LAN; l++)
+		{
+			k.tong += s[l];
+			k.tongBinhPhuong += s2[l];
+			k.soDat += dat[l];
+		}
+	}
+	k.nhoNhat = *min_element(nho, nho + LAN);
+	k.lonNhat = *max_element(lon, lon + LAN);
+
+	for(size_t i = 0; i < n; i++)
+	{
+		int b = (int)x[i];
+		k.ngan[b < 0 ? 0 : b >= SO_NGAN ? SO_NGAN - 1 : b]++;
+	}
+	return k;
+}
+
+ThongKe thongKe(const float *x, size_t n, int soThread)
+{
+	vector<ThongKe> rieng(max(soThread, 1));
+	chiaDoan(n, soThread, [&](size_t dau, size_t cuoi, int t) {
+		rieng[t] = thongKeDoan(x + dau, cuoi - dau);
+	});
+	ThongKe k = {};
+	for(size_t t = 0; t < rieng.size(); t++)
+		k.gop(rieng[t]);
+	return k;
+}
+
+// k dong co diem cao nhat (diem bang nhau: dong dung truoc xep truoc).
+// Moi thread giu mot heap k phan tu cho doan cua no, sau do gop lai.
+vector<uint32_t> topK(const float *diem, size_t n, size_t k, int soThread)
+{
+	// a "tot hon" b
+	auto totHon = [diem](uint32_t a, uint32_t b) {
+		return diem[a] > diem[b] || (diem[a] == diem[b] && a < b);
+	};
+	vector<vector<uint32_t> > heap(max(soThread, 1));
+	chiaDoan(n, soThread, [&](size_t dau, size_t cuoi, int t) {
+		vector<uint32_t> &h = heap[t];	// dinh heap la phan tu kem nhat
+		for(size_t i = dau; i < cuoi; i++)
+		{
+			if(h.size() < k)
+			{
+				h.push_back(i);
+				push_heap(h.begin(), h.end(), totHon);
+			}
+			else if(k > 0 && totHon(i, h.front()))
+			{
+				pop_heap(h.begin(), h.end(), totHon);
+				h.back() = i;
+				push_heap(h.begin(), h.end(), totHon);
+			}
+		}
+	});
+	vector<uint32_t> kq;
+	for(size_t t = 0; t < heap.size(); t++)
+		kq.insert(kq.end(), heap[t].begin(), heap[t].end());
+	size_t m = min(k, kq.size());
+	partial_sort(kq.begin(), kq.begin() + m, kq.end(), totHon);
+	kq.resize(m);
+	return kq;
+}
+
+// ---------------------------------------------------------------------------
+// Chi muc MSSV -> dong: bang bam dia chi mo (open addressing, do tuyen tinh),
+// kich thuoc luy thua 2 va it nhat gap doi so dong. MSSV trung nhau thi giu
+// dong dau tien.
+
+const uint32_t KHONG_CO = 0xFFFFFFFFu;
+
+struct ChiMucMssv
+{
+	vector<uint32_t> khoa, dong;
+	uint32_t mat;	// kich thuoc - 1
+	int dich;
+
+	void xay(const vector<uint32_t> &mssv);
+	uint32_t viTri(uint32_t m) const { return (uint32_t)(m * 0x9E3779B1u) >> dich & mat; }
+	uint32_t tim(uint32_t m) const;	// so dong, KHONG_CO neu khong co
+};
+
+void ChiMucMssv::xay(const vector<uint32_t> &mssv)
+{
+	size_t kichThuoc = 16;
+	dich = 28;
+	while(kichThuoc < 2 * mssv.size())
+	{
+		kichThuoc *= 2;
+		dich--;
+	}
+	if(dich < 0)
+		dich = 0;
+	mat = kichThuoc - 1;
+	khoa.assign(kichThuoc, 0);
+	dong.assign(kichThuoc, KHONG_CO);
+	for(size_t i = 0; i < mssv.size(); i++)
+	{
+		uint32_t o = viTri(mssv[i]);
+		while(dong[o] != KHONG_CO && khoa[o] != mssv[i])
+			o = (o + 1) & mat;
+		if(dong[o] == KHONG_CO)
+		{
+			khoa[o] = mssv[i];
+			dong[o] = i;
+		}
+	}
+}
+
+uint32_t ChiMucMssv::tim(uint32_t m) const
+{
+	uint32_t o = viTri(m);
+	while(dong[o] != KHONG_CO)
+	{
+		if(khoa[o] == m)
+			return dong[o];
+		o = (o + 1) & mat;
+	}
+	return KHONG_CO;
+}
+
+void inThongKe(const char *ten, const ThongKe &k)
+{
+	printf("%-5s tb %.3f  do lech %.3f  min %g  max %g  dat %zu / %zu\n", ten,
+		k.trungBinh(), sqrt(max(k.phuongSai(), 0.0)), k.nhoNhat, k.lonNhat, k.soDat, k.n);
+	printf("      ");
+	for(int i = 0; i < SO_NGAN; i++)
+		printf(" %d:%zu", i, k.ngan[i]);
+	printf("\n");
+}
+
+// Tao tep thu nghiem n dong cung dinh dang Diem.csv (diem le 0.5)
+bool taoTepThu(const char *duongDan, size_t n)
+{
+	FILE *f = fopen(duongDan, "wb");
+	if(!f)
+		return false;
+	vector<char> buf(1 << 20);
+	size_t len = 0;
+	uint64_t x = 0x9E3779B97F4A7C15ull;
+	len += sprintf(&buf[len], "MSSV,Diem GK,Diem CK\r\n");
+	for(size_t i = 0; i < n; i++)
+	{
+		if(len + 64 > buf.size())
+		{
+			fwrite(buf.data(), 1, len, f);
+			len = 0;
+		}
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		int gk = x % 21, ck = (x >> 8) % 21;
+		len += sprintf(&buf[len], "%u,%d%s,%d%s\r\n", (unsigned)(1500000 + i), gk / 2,
+			gk % 2 ? ".5" : "", ck / 2, ck % 2 ? ".5" : "");
+	}
+	fwrite(buf.data(), 1, len, f);
+	return fclose(f) == 0;
+}
+
+// Cach dung:
+//   diem [tep.csv] [so thread] [mssv ...]
+//                                  doc tep (mac dinh Diem.csv), in toc do,
+//                                  thong ke, top 10 va diem cua cac mssv
+//   diem --tao <so dong> <tep.csv> tao tep thu nghiem
+int main(int argc, char *argv[])
+{
+	if(argc >= 4 && strcmp(argv[1], "--tao") == 0)
+	{
+		if(!taoTepThu(argv[3], strtoull(argv[2], NULL, 10)))
+		{
+			fprintf(stderr, "Khong ghi duoc %s\n", argv[3]);
+			return 1;
+		}
+		return 0;
+	}
+
+	const char *duongDan = argc >= 2 ? argv[1] : "Diem.csv";
+	int soThread = argc >= 3 ? atoi(argv[2]) : hardwareThreads();
+
+	BangDiem bd;
+	chrono::steady_clock::time_point batDau = chrono::steady_clock::now();
+	if(!docBangDiem(duongDan, bd, soThread))
+	{
+		fprintf(stderr, "Khong doc duoc %s\n", duongDan);
+		return 1;
+	}
+	double giay = chrono::duration<double>(chrono::steady_clock::now() - batDau).count();
+
+	struct stat st;
+	double mb = stat(duongDan, &st) == 0 ? st.st_size / 1e6 : 0;
+	printf("%zu dong (%zu dong loi), %.1f MB, %.3f s, %.0f dong/s, %.0f MB/s\n",
+		bd.size(), bd.soDongLoi, mb, giay, giay > 0 ? bd.size() / giay : 0.0,
+		giay > 0 ? mb / giay : 0.0);
+
+	batDau = chrono::steady_clock::now();
+	vector<float> tong(bd.size());
+	tinhDiemTong(bd.gk.data(), bd.ck.data(), tong.data(), bd.size(), soThread);
+	ThongKe gk = thongKe(bd.gk.data(), bd.size(), soThread);
+	ThongKe ck = thongKe(bd.ck.data(), bd.size(), soThread);
+	ThongKe tk = thongKe(tong.data(), bd.size(), soThread);
+	vector<uint32_t> top = topK(tong.data(), bd.size(), 10, soThread);
+	ChiMucMssv chiMuc;
+	chiMuc.xay(bd.mssv);
+	giay = chrono::duration<double>(chrono::steady_clock::now() - batDau).count();
+
+	inThongKe("GK", gk);
+	inThongKe("CK", ck);
+	inThongKe("Tong", tk);
+	printf("Top %zu:\n", top.size());
+	for(size_t i = 0; i < top.size(); i++)
+		printf("  %u\t%g\t%g\t%.2f\n", bd.mssv[top[i]], bd.gk[top[i]], bd.ck[top[i]], tong[top[i]]);
+	printf("Thong ke + top + chi muc: %.3f s\n", giay);
+
+	for(int i = 3; i < argc; i++)
+	{
+		uint32_t m = strtoul(argv[i], NULL, 10);
+		uint32_t d = chiMuc.tim(m);
+		if(d == KHONG_CO)
+			printf("%u: khong co\n", m);
+		else
+			printf("%u: GK %g, CK %g, tong %.2f\n", m, bd.gk[d], bd.ck[d], tong[d]);
+	}
+	return 0;
+}
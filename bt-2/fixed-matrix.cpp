@@ -0,0 +1,282 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "../common/out_buffer.cpp"
+#include "../common/rng.cpp"
+using namespace std;
+
+// Ma tran kich thuoc co dinh luc bien dich (khac Matrix co kich thuoc luc
+// chay): du lieu nam ngay trong struct, khong cap phat heap, sai kich thuoc
+// la loi bien dich. Vong lap co so lan lap la hang so nen trinh bien dich
+// trai (unroll) het duoc voi ma tran nho nhu 3x3.
+
+template <int R, int C> struct FixedMatrix {
+  static_assert(R > 0 && C > 0, "FixedMatrix dimensions must be positive");
+  static constexpr int rows = R;
+  static constexpr int cols = C;
+  int data[R][C];
+
+  constexpr FixedMatrix() : data{} {}
+
+  constexpr FixedMatrix addition(const FixedMatrix &other) const;
+  constexpr FixedMatrix subtraction(const FixedMatrix &other) const;
+  constexpr FixedMatrix scalarMultiplication(int scalar) const;
+  constexpr FixedMatrix<C, R> transpose() const;
+  template <int K>
+  constexpr FixedMatrix<R, K>
+  multiplication(const FixedMatrix<C, K> &other) const;
+  void print() const;
+  void seed(uint64_t seed);
+};
+
+template <int R, int C>
+constexpr FixedMatrix<R, C>
+FixedMatrix<R, C>::addition(const FixedMatrix &other) const {
+  FixedMatrix result;
+  for (int i = 0; i < R; i++)
+    for (int j = 0; j < C; j++)
+      result.data[i][j] = data[i][j] + other.data[i][j];
+  return result;
+}
+
+template <int R, int C>
+constexpr FixedMatrix<R, C>
+FixedMatrix<R, C>::subtraction(const FixedMatrix &other) const {
+  FixedMatrix result;
+  for (int i = 0; i < R; i++)
+    for (int j = 0; j < C; j++)
+      result.data[i][j] = data[i][j] - other.data[i][j];
+  return result;
+}
+
+template <int R, int C>
+constexpr FixedMatrix<R, C>
+FixedMatrix<R, C>::scalarMultiplication(int scalar) const {
+  FixedMatrix result;
+  for (int i = 0; i < R; i++)
+    for (int j = 0; j < C; j++)
+      result.data[i][j] = data[i][j] * scalar;
+  return result;
+}
+
+template <int R, int C>
+constexpr FixedMatrix<C, R> FixedMatrix<R, C>::transpose() const {
+  FixedMatrix<C, R> result;
+  for (int i = 0; i < R; i++)
+    for (int j = 0; j < C; j++)
+      result.data[j][i] = data[i][j];
+  return result;
+}
+
+// So cot cua ma tran thu nhat bang so hang cua ma tran thu hai: kiem tra
+// luc bien dich qua kieu FixedMatrix<C, K>
+template <int R, int C>
+template <int K>
+constexpr FixedMatrix<R, K>
+FixedMatrix<R, C>::multiplication(const FixedMatrix<C, K> &other) const {
+  FixedMatrix<R, K> result;
+  for (int i = 0; i < R; i++)
+    for (int k = 0; k < C; k++)
+      for (int j = 0; j < K; j++)
+        result.data[i][j] += data[i][k] * other.data[k][j];
+  return result;
+}
+
+// Cung dang voi Matrix::print, gom ca bang vao bo dem roi ghi ra mot lan
+template <int R, int C> void FixedMatrix<R, C>::print() const {
+  OutBuffer out;
+  out.putChar('+');
+  for (int j = 0; j < C; j++)
+    out.write("----", 4);
+  out.write("+\n", 2);
+  for (int i = 0; i < R; i++) {
+    out.putChar('|');
+    for (int j = 0; j < C; j++) {
+      out.putInt(data[i][j], 3);
+      out.putChar(' ');
+    }
+    out.write("|\n", 2);
+  }
+  out.putChar('+');
+  for (int j = 0; j < C; j++)
+    out.write("----", 4);
+  out.write("+\n", 2);
+}
+
+template <int R, int C> void FixedMatrix<R, C>::seed(uint64_t seed) {
+  fillUniform(&data[0][0], R * C, seed, 0, 99, 1);
+}
+
+// Lo (batch) nhieu ma tran RxC cung kich thuoc, luu kieu struct-of-arrays:
+// phan tu (i, j) cua moi ma tran nam lien nhau, tuc element(i, j)[b] la
+// phan tu (i, j) cua ma tran thu b. Moi phep toan la R*C (hoac R*K*C) vong
+// lap chay doc theo b tren mang lien tuc, nen duoc vector hoa (SIMD) thang.
+template <int R, int C> struct MatrixBatch {
+  int count;
+  vector<int> data;
+
+  MatrixBatch(int count) : count(count), data((size_t)R * C * count) {}
+
+  int *element(int i, int j) { return data.data() + ((size_t)i * C + j) * count; }
+  const int *element(int i, int j) const {
+    return data.data() + ((size_t)i * C + j) * count;
+  }
+  FixedMatrix<R, C> get(int b) const;
+  void set(int b, const FixedMatrix<R, C> &m);
+  void seed(uint64_t seed);
+
+  void addition(const MatrixBatch &other, MatrixBatch &result) const;
+  void subtraction(const MatrixBatch &other, MatrixBatch &result) const;
+  void scalarMultiplication(int scalar, MatrixBatch &result) const;
+  void transpose(MatrixBatch<C, R> &result) const;
+  template <int K>
+  void multiplication(const MatrixBatch<C, K> &other,
+                      MatrixBatch<R, K> &result) const;
+};
+
+template <int R, int C> FixedMatrix<R, C> MatrixBatch<R, C>::get(int b) const {
+  FixedMatrix<R, C> m;
+  for (int i = 0; i < R; i++)
+    for (int j = 0; j < C; j++)
+      m.data[i][j] = element(i, j)[b];
+  return m;
+}
+
+template <int R, int C>
+void MatrixBatch<R, C>::set(int b, const FixedMatrix<R, C> &m) {
+  for (int i = 0; i < R; i++)
+    for (int j = 0; j < C; j++)
+      element(i, j)[b] = m.data[i][j];
+}
+
+template <int R, int C> void MatrixBatch<R, C>::seed(uint64_t seed) {
+  fillUniform(data.data(), data.size(), seed, 0, 99);
+}
+
+// Cac ket qua phai co cung count voi lo nguon (nguoi goi tu tao)
+template <int R, int C>
+void MatrixBatch<R, C>::addition(const MatrixBatch &other,
+                                 MatrixBatch &result) const {
+  const int *a = data.data(), *b = other.data.data();
+  int *out = result.data.data();
+  for (size_t i = 0; i < data.size(); i++)
+    out[i] = a[i] + b[i];
+}
+
+template <int R, int C>
+void MatrixBatch<R, C>::subtraction(const MatrixBatch &other,
+                                    MatrixBatch &result) const {
+  const int *a = data.data(), *b = other.data.data();
+  int *out = result.data.data();
+  for (size_t i = 0; i < data.size(); i++)
+    out[i] = a[i] - b[i];
+}
+
+template <int R, int C>
+void MatrixBatch<R, C>::scalarMultiplication(int scalar,
+                                             MatrixBatch &result) const {
+  const int *a = data.data();
+  int *out = result.data.data();
+  for (size_t i = 0; i < data.size(); i++)
+    out[i] = a[i] * scalar;
+}
+
+// Chuyen vi chi la doi cho cac cot (i, j) -> (j, i), moi cot chep nguyen khoi
+template <int R, int C>
+void MatrixBatch<R, C>::transpose(MatrixBatch<C, R> &result) const {
+  for (int i = 0; i < R; i++)
+    for (int j = 0; j < C; j++) {
+      const int *src = element(i, j);
+      int *dst = result.element(j, i);
+      for (int b = 0; b < count; b++)
+        dst[b] = src[b];
+    }
+}
+
+template <int R, int C>
+template <int K>
+void MatrixBatch<R, C>::multiplication(const MatrixBatch<C, K> &other,
+                                       MatrixBatch<R, K> &result) const {
+  for (int i = 0; i < R; i++)
+    for (int j = 0; j < K; j++) {
+      int *__restrict out = result.element(i, j);
+      for (int b = 0; b < count; b++)
+        out[b] = 0;
+      for (int k = 0; k < C; k++) {
+        const int *__restrict x = element(i, k);
+        const int *__restrict y = other.element(k, j);
+        for (int b = 0; b < count; b++)
+          out[b] += x[b] * y[b];
+      }
+    }
+}
+
+// Tinh luc bien dich: I * I = I
+constexpr FixedMatrix<3, 3> identity3() {
+  FixedMatrix<3, 3> m;
+  for (int i = 0; i < 3; i++)
+    m.data[i][i] = 1;
+  return m;
+}
+static_assert(identity3().multiplication(identity3()).data[2][2] == 1,
+              "constexpr FixedMatrix multiplication");
+
+void demoFixedMatrix() {
+  uint64_t seed = seedFromEnv();
+  FixedMatrix<3, 3> matrix1, matrix2;
+  matrix1.seed(deriveSeed(seed, 1));
+  matrix2.seed(deriveSeed(seed, 2));
+  cout << "Fixed matrix 1: " << endl;
+  matrix1.print();
+  cout << "Fixed matrix 2: " << endl;
+  matrix2.print();
+
+  cout << "Addition: matrix1 + matrix2 =" << endl;
+  matrix1.addition(matrix2).print();
+  cout << "Subtraction: matrix1 - matrix2 =" << endl;
+  matrix1.subtraction(matrix2).print();
+  cout << "Scalar Multiplication: 2 * matrix1 =" << endl;
+  matrix1.scalarMultiplication(2).print();
+  cout << "Transpose: matrix1 =" << endl;
+  matrix1.transpose().print();
+  cout << "Multiplication: matrix1 * matrix2 =" << endl;
+  matrix1.multiplication(matrix2).print();
+
+  // Nhan 2 lo ma tran 3x3: tung cap mot (FixedMatrix) va ca lo mot lan
+  const int count = 1 << 16;
+  const int rounds = 50;
+  MatrixBatch<3, 3> a(count), b(count), batchResult(count);
+  a.seed(deriveSeed(seed, 3));
+  b.seed(deriveSeed(seed, 4));
+  vector<FixedMatrix<3, 3>> as(count), bs(count), oneResult(count);
+  for (int i = 0; i < count; i++) {
+    as[i] = a.get(i);
+    bs[i] = b.get(i);
+  }
+
+  auto start = chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++)
+    for (int i = 0; i < count; i++)
+      oneResult[i] = as[i].multiplication(bs[i]);
+  double oneByOne =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  start = chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++)
+    a.multiplication(b, batchResult);
+  double batched =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  int mismatches = 0;
+  for (int i = 0; i < count; i++) {
+    FixedMatrix<3, 3> m = batchResult.get(i);
+    for (int x = 0; x < 3; x++)
+      for (int y = 0; y < 3; y++)
+        mismatches += m.data[x][y] != oneResult[i].data[x][y];
+  }
+  printf("Multiply %d pairs of 3x3 x %d: one by one %.3f s, batch %.3f s, "
+         "mismatches %d\n",
+         count, rounds, oneByOne, batched, mismatches);
+}
@@ -1,5 +1,5 @@
-#include <__config>
 #include <iostream>
+#include "../common/rng.cpp"
 using namespace std;
 
 struct Node {
@@ -11,17 +11,17 @@ struct LinkList {
   Node *head;
 
   public:
-  void seed(int size);
+  void seed(int size, uint64_t seed = DEFAULT_SEED);
   void print();
 };
 
-void LinkList::seed(int size) {
-  std::srand(std::time(nullptr));
+void LinkList::seed(int size, uint64_t seed) {
+  Rng rng(seed);
   head = nullptr;
   Node *tail;
   for (int i = 0; i < size; i++) {
     Node *newNode = new Node();
-    newNode->data = rand() % 10;
+    newNode->data = rng.between(0, 9);
     newNode->next = nullptr;
     if (!head) {
       head = newNode;
@@ -66,7 +66,7 @@ Node* searchRec(Node *head, int value) {
 
 void demoLinkList() {
   LinkList list;
-  list.seed(10);
+  list.seed(10, seedFromEnv());
   list.print();
 
   cout << "Searching for node with value 4 using loop" << endl;
@@ -1,9 +1,14 @@
 #include "matrix.cpp"
+#include "fixed-matrix.cpp"
 #include "queue.cpp"
+#include "sliding-window.cpp"
 #include "link-list.cpp"
 
 int main() {
   demoMatrixOperations();
+  demoFixedMatrix();
+  demoMatrixIO();
+  demoSlidingWindow();
   // demoLinkList();
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "../common/out_buffer.cpp"
+#include "../common/threads.cpp"
+using namespace std;
+
+// Doc / ghi bang so nguyen dang van ban cho Matrix (matrix.cpp). Ghi dung
+// OutBuffer (common/out_buffer.cpp).
+
+// Doc bang so: moi dong mot hang, cac so cach nhau boi space, tab hoac ','
+// (CSV). Moi dau ',' phai nam giua hai so: o rong nhu "1,,2", ",1" hay "1,"
+// bi tu choi. Dong rong bi bo qua, '\r' cua CRLF duoc chap nhan.
+// Van ban chia thanh cac doan theo ranh gioi dong, moi thread doc mot doan
+// bang from_chars vao mang rieng; sau do ghep cac doan theo thu tu.
+
+struct IntTable {
+  int rows;
+  int cols;
+  vector<int> values; // rows * cols, theo hang
+};
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Doc [p, end); tra ve false neu co token khong phai so, o rong hoac so cot
+// khong deu
+bool parseChunk(const char *p, const char *end, IntTable &out) {
+  out.rows = 0;
+  out.cols = -1;
+  out.values.clear();
+  out.values.reserve((end - p) / 4); // uoc luong: so ngan + dau cach
+  while (p < end) {
+    const char *newline = (const char *)memchr(p, '\n', end - p);
+    const char *lineEnd = newline ? newline : end;
+    int cols = 0;
+    bool afterComma = false; // vua qua ',': phai co so tiep theo
+    while (true) {
+      while (p < lineEnd && isBlank(*p))
+        p++;
+      if (p >= lineEnd) {
+        if (afterComma)
+          return false;
+        break;
+      }
+      if (*p == ',') {
+        if (cols == 0 || afterComma)
+          return false;
+        afterComma = true;
+        p++;
+        continue;
+      }
+      int value;
+      from_chars_result r = from_chars(p, lineEnd, value);
+      if (r.ec != errc() ||
+          (r.ptr < lineEnd && !isBlank(*r.ptr) && *r.ptr != ','))
+        return false;
+      out.values.push_back(value);
+      cols++;
+      afterComma = false;
+      p = r.ptr;
+    }
+    if (cols > 0) {
+      if (out.cols >= 0 && cols != out.cols)
+        return false;
+      out.cols = cols;
+      out.rows++;
+    }
+    p = lineEnd + 1;
+  }
+  return true;
+}
+
+// Doc ca van ban thanh mot bang; threads <= 0 thi dung so nhan CPU
+bool parseIntTable(const char *text, size_t len, int threads, IntTable &out) {
+  if (threads <= 0)
+    threads = hardwareThreads();
+  if (len < (1 << 20))
+    threads = 1;
+  const char *end = text + len;
+  vector<const char *> bounds(threads + 1);
+  bounds[0] = text;
+  for (int t = 1; t < threads; t++) {
+    const char *q = text + len * t / threads;
+    if (q < bounds[t - 1])
+      q = bounds[t - 1];
+    const char *newline = (const char *)memchr(q, '\n', end - q);
+    bounds[t] = newline ? newline + 1 : end;
+  }
+  bounds[threads] = end;
+
+  if (threads == 1)
+    return parseChunk(text, end, out);
+
+  vector<IntTable> parts(threads);
+  vector<char> ok(threads);
+  vector<thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      ok[t] = parseChunk(bounds[t], bounds[t + 1], parts[t]);
+    });
+  }
+  for (thread &w : workers)
+    w.join();
+
+  out.rows = 0;
+  out.cols = -1;
+  vector<size_t> offsets(threads + 1, 0);
+  for (int t = 0; t < threads; t++) {
+    if (!ok[t])
+      return false;
+    if (parts[t].rows > 0) {
+      if (out.cols >= 0 && parts[t].cols != out.cols)
+        return false;
+      out.cols = parts[t].cols;
+    }
+    out.rows += parts[t].rows;
+    offsets[t + 1] = offsets[t] + parts[t].values.size();
+  }
+  out.values.resize(offsets[threads]);
+  workers.clear();
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      memcpy(out.values.data() + offsets[t], parts[t].values.data(),
+             parts[t].values.size() * sizeof(int));
+    });
+  }
+  for (thread &w : workers)
+    w.join();
+  return true;
+}
+
+// Doc ca file vao bo nho
+bool readWholeFile(const char *path, vector<char> &text) {
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return false;
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  text.resize(size > 0 ? size : 0);
+  bool ok = size >= 0 && fread(text.data(), 1, text.size(), file) == text.size();
+  fclose(file);
+  return ok;
+}
@@ -1,6 +1,10 @@
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <stdlib.h>
+#include "matrix-io.cpp"
+#include "../common/rng.cpp"
+#include "../common/temp_path.cpp"
 using namespace std;
 
 // define a matrix struct and Basic operations methods
@@ -18,7 +22,11 @@ public:
   Matrix transpose();
   Matrix multiplication(Matrix &other);
   void print();
-  void seed();
+  void seed(uint64_t seed = DEFAULT_SEED);
+  void write(FILE *file = stdout, char separator = ' ');
+  bool save(const char *path, char separator = ' ');
+  bool parse(const char *text, size_t len, int threads = 0);
+  bool load(const char *path, int threads = 0);
 };
 
 Matrix::Matrix(int rows, int cols) {
@@ -96,44 +104,89 @@ Matrix Matrix::multiplication(Matrix &other){
 }
 
 void Matrix::print() {
-  // Print top border
-  cout << "+";
+  // Gom ca bang vao bo dem, ghi ra mot lan
+  OutBuffer out;
+  out.putChar('+');
   for (int j = 0; j < cols; j++) {
-    cout << "----";
+    out.write("----", 4);
   }
-  cout << "+" << endl;
-  // Print matrix contents with borders
+  out.write("+\n", 2);
   for (int i = 0; i < rows; i++) {
-    cout << "|";
+    out.putChar('|');
     for (int j = 0; j < cols; j++) {
-      printf("%3d ", data[i][j]); // Right-align numbers with width 3
+      out.putInt(data[i][j], 3); // Right-align numbers with width 3
+      out.putChar(' ');
     }
-    cout << "|" << endl;
+    out.write("|\n", 2);
   }
-  // Print bottom border
-  cout << "+";
+  out.putChar('+');
   for (int j = 0; j < cols; j++) {
-    cout << "----";
+    out.write("----", 4);
   }
-  cout << "+" << endl;
+  out.write("+\n", 2);
 }
 
-void Matrix::seed() {
+// Cac hang noi tiep nhau thanh mot day cua seed: cung seed, cung ma tran
+void Matrix::seed(uint64_t seed) {
+  for (int i = 0; i < rows; i++) {
+    fillUniform(data[i], cols, seed, 0, 99, 1, (uint64_t)i * cols);
+  }
+}
+
+// Dang van ban cho may doc: moi hang mot dong, cac so cach nhau boi separator
+void Matrix::write(FILE *file, char separator) {
+  OutBuffer out(file);
   for (int i = 0; i < rows; i++) {
     for (int j = 0; j < cols; j++) {
-      data[i][j] = rand() % 100;
+      if (j > 0)
+        out.putChar(separator);
+      out.putInt(data[i][j]);
     }
+    out.putChar('\n');
+  }
+}
+
+bool Matrix::save(const char *path, char separator) {
+  FILE *file = fopen(path, "wb");
+  if (!file)
+    return false;
+  write(file, separator);
+  return fclose(file) == 0;
+}
+
+// Thay noi dung ma tran bang bang so doc tu text (space/tab hoac CSV).
+// Loi dinh dang thi tra ve false va giu nguyen ma tran.
+bool Matrix::parse(const char *text, size_t len, int threads) {
+  IntTable table;
+  if (!parseIntTable(text, len, threads, table))
+    return false;
+  for (int i = 0; i < rows; i++) {
+    delete[] data[i];
+  }
+  delete[] data;
+  rows = table.rows;
+  cols = table.rows > 0 ? table.cols : 0;
+  data = new int *[rows];
+  for (int i = 0; i < rows; i++) {
+    data[i] = new int[cols];
+    memcpy(data[i], table.values.data() + (size_t)i * cols, cols * sizeof(int));
   }
+  return true;
+}
+
+bool Matrix::load(const char *path, int threads) {
+  vector<char> text;
+  return readWholeFile(path, text) && parse(text.data(), text.size(), threads);
 }
 
 void demoMatrixOperations() {
-  srand(time(nullptr));
+  uint64_t seed = seedFromEnv();
   Matrix matrix1(3, 3);
-  matrix1.seed();
+  matrix1.seed(deriveSeed(seed, 1));
   cout << "Matrix 1: " << endl;
   matrix1.print();
   Matrix matrix2(3, 3);
-  matrix2.seed();
+  matrix2.seed(deriveSeed(seed, 2));
   cout << "Matrix 2: " << endl;
   matrix2.print();
 
@@ -156,4 +209,59 @@ void demoMatrixOperations() {
   cout << "Multiplication: matrix1 * matrix2 =" << endl;
   result = matrix1.multiplication(matrix2);
   result.print();
-}
\ No newline at end of file
+}
+
+// Ghi ma tran lon ra file tam trong $TMPDIR roi doc lai, khong ghi gi vao
+// thu muc hien tai
+void demoMatrixIO() {
+  string tmp = tempPath("matrix-demo");
+  if (tmp.empty()) {
+    cout << "Error: cannot create temp file" << endl;
+    return;
+  }
+  const char *path = tmp.c_str();
+  Matrix big(2000, 2000);
+  big.seed(deriveSeed(seedFromEnv(), 3));
+
+  auto start = chrono::steady_clock::now();
+  if (!big.save(path)) {
+    cout << "Error: cannot write " << path << endl;
+    remove(path);
+    return;
+  }
+  double writeTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  vector<char> text;
+  readWholeFile(path, text);
+  double mb = text.size() / 1e6;
+
+  Matrix loaded(0, 0);
+  start = chrono::steady_clock::now();
+  bool ok = loaded.parse(text.data(), text.size());
+  double readTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  remove(path);
+
+  int mismatches = ok && loaded.rows == big.rows && loaded.cols == big.cols ? 0 : -1;
+  for (int i = 0; mismatches >= 0 && i < big.rows; i++)
+    for (int j = 0; j < big.cols; j++)
+      mismatches += loaded.data[i][j] != big.data[i][j];
+  printf("Matrix %dx%d, %.1f MB text: write %.0f MB/s, parse %.0f MB/s, "
+         "mismatches %d\n",
+         big.rows, big.cols, mb, mb / writeTime, mb / readTime, mismatches);
+
+  // CSV hop le (ca CRLF, dau cach quanh ',') phai doc duoc; o rong, token
+  // la va hang le phai bi tu choi, ma tran giu nguyen
+  const char *good[] = {"1,2\n3,4\n", "1, 2\r\n3 ,4\r\n", "1 2\n\n3 4"};
+  const char *bad[] = {"1,,2\n3,4,5\n", ",1\n2,3\n", "1,\n2,\n",
+                       "1,2\n3\n", "1,x\n3,4\n"};
+  int accepted = 0, rejected = 0;
+  for (const char *t : good)
+    accepted += loaded.parse(t, strlen(t)) && loaded.rows == 2 &&
+                loaded.cols == 2 && loaded.data[1][0] == 3;
+  for (const char *t : bad)
+    rejected += !loaded.parse(t, strlen(t)) && loaded.rows == 2;
+  printf("CSV checks: %d/%zu valid tables accepted, %d/%zu malformed rejected\n",
+         accepted, sizeof(good) / sizeof(*good), rejected,
+         sizeof(bad) / sizeof(*bad));
+}
@@ -0,0 +1,228 @@
+#include <cassert>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "../common/rng.cpp"
+#include "queue.cpp"
+using namespace std;
+
+// Hang doi hai dau tren bo dem vong (ring buffer): dung luong luy thua 2,
+// head chay vong quanh nen pop_front / push_front la O(1), khong dich ca
+// mang nhu Deque (queue.cpp) dung vector::erase / insert o dau.
+template <typename T> struct RingDeque {
+  vector<T> buf;
+  size_t head;  // vi tri phan tu dau
+  size_t count; // so phan tu
+  size_t mask;  // buf.size() - 1
+
+  RingDeque(size_t capacity = 16);
+  void push_back(const T &value);
+  void push_front(const T &value);
+  T pop_back();
+  T pop_front();
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  T &front() { return buf[head]; }
+  T &back() { return buf[(head + count - 1) & mask]; }
+  T &operator[](size_t i) { return buf[(head + i) & mask]; }
+  void clear() { head = count = 0; }
+
+private:
+  void grow();
+};
+
+template <typename T> RingDeque<T>::RingDeque(size_t capacity) : head(0), count(0) {
+  size_t size = 1;
+  while (size < capacity)
+    size *= 2;
+  buf.resize(size);
+  mask = size - 1;
+}
+
+// Day: chep lai theo thu tu vao mang gap doi, head ve 0
+template <typename T> void RingDeque<T>::grow() {
+  vector<T> bigger(buf.size() * 2);
+  for (size_t i = 0; i < count; i++)
+    bigger[i] = buf[(head + i) & mask];
+  buf.swap(bigger);
+  head = 0;
+  mask = buf.size() - 1;
+}
+
+template <typename T> void RingDeque<T>::push_back(const T &value) {
+  if (count == buf.size())
+    grow();
+  buf[(head + count) & mask] = value;
+  count++;
+}
+
+template <typename T> void RingDeque<T>::push_front(const T &value) {
+  if (count == buf.size())
+    grow();
+  head = (head - 1) & mask;
+  buf[head] = value;
+  count++;
+}
+
+template <typename T> T RingDeque<T>::pop_back() {
+  count--;
+  return buf[(head + count) & mask];
+}
+
+template <typename T> T RingDeque<T>::pop_front() {
+  T value = buf[head];
+  head = (head + 1) & mask;
+  count--;
+  return value;
+}
+
+// Tong hop cua so truot (sliding window) cho luong so: giu width phan tu
+// moi nhat, min / max / sum trong O(1).
+// Min, max dung hang doi don dieu: minQueue chi giu cac phan tu co the con
+// la min cua mot cua so sau nay (gia tri tang dan tu dau toi cuoi), phan tu
+// moi day ra sau het cac phan tu >= no. Moi phan tu vao / ra moi hang doi
+// dung mot lan nen push la O(1) khau hao.
+// Cua so rong (chua push gi): min() = INT_MAX, max() = INT_MIN, sum() = 0.
+struct WindowEntry {
+  long long pos; // thu tu trong luong, de biet khi nao ra khoi cua so
+  int value;
+};
+
+struct SlidingWindow {
+  size_t width;
+  long long pushed; // so phan tu da vao
+  long long total;  // tong cac phan tu trong cua so
+  RingDeque<int> values;
+  RingDeque<WindowEntry> minQueue, maxQueue;
+
+  SlidingWindow(size_t width)
+      : width(width), pushed(0), total(0), values(width + 1),
+        minQueue(width + 1), maxQueue(width + 1) {
+    assert(width > 0 && "SlidingWindow width must be positive");
+  }
+  void push(int value);
+  size_t size() const { return values.size(); }
+  bool full() const { return values.size() == width; }
+  int min() { return minQueue.empty() ? INT_MAX : minQueue.front().value; }
+  int max() { return maxQueue.empty() ? INT_MIN : maxQueue.front().value; }
+  long long sum() const { return total; }
+  // Day ca mang vao; sau moi phan tu ghi min / max / sum cua cua so vao
+  // mang ra tuong ung (nullptr: khong can)
+  void pushBatch(const int *in, size_t n, int *minOut, int *maxOut,
+                 long long *sumOut);
+  void clear();
+
+private:
+  void evict(); // bo phan tu cu nhat
+};
+
+void SlidingWindow::push(int value) {
+  long long pos = pushed++;
+  values.push_back(value);
+  total += value;
+  while (!minQueue.empty() && minQueue.back().value >= value)
+    minQueue.pop_back();
+  minQueue.push_back({pos, value});
+  while (!maxQueue.empty() && maxQueue.back().value <= value)
+    maxQueue.pop_back();
+  maxQueue.push_back({pos, value});
+  if (values.size() > width)
+    evict();
+}
+
+void SlidingWindow::evict() {
+  long long oldest = pushed - values.size();
+  total -= values.pop_front();
+  if (minQueue.front().pos == oldest)
+    minQueue.pop_front();
+  if (maxQueue.front().pos == oldest)
+    maxQueue.pop_front();
+}
+
+void SlidingWindow::pushBatch(const int *in, size_t n, int *minOut,
+                              int *maxOut, long long *sumOut) {
+  for (size_t i = 0; i < n; i++) {
+    push(in[i]);
+    if (minOut)
+      minOut[i] = min();
+    if (maxOut)
+      maxOut[i] = max();
+    if (sumOut)
+      sumOut[i] = total;
+  }
+}
+
+void SlidingWindow::clear() {
+  pushed = total = 0;
+  values.clear();
+  minQueue.clear();
+  maxQueue.clear();
+}
+
+// Min cua so truot bang Deque cu (pop_front la vector::erase, O(n)) de so sanh
+void slidingMinWithDeque(const int *in, size_t n, size_t width, int *out) {
+  Deque positions;
+  for (size_t i = 0; i < n; i++) {
+    while (positions.size() > 0 && in[positions.back()] >= in[i])
+      positions.pop_back();
+    positions.push_back(i);
+    if ((size_t)positions.front() + width <= i)
+      positions.pop_front();
+    out[i] = in[positions.front()];
+  }
+}
+
+void demoSlidingWindow() {
+  int stream[] = {5, 3, 8, 1, 9, 2, 7, 4, 6};
+  SlidingWindow window(3);
+  cout << "Window 3: value -> min max sum" << endl;
+  cout << "(empty) -> " << window.min() << " " << window.max() << " "
+       << window.sum() << endl;
+  for (int value : stream) {
+    window.push(value);
+    cout << value << " -> " << window.min() << " " << window.max() << " "
+         << window.sum() << endl;
+  }
+
+  // Kiem tra voi cach tinh truc tiep
+  const size_t n = 100000;
+  vector<int> data = uniformKeys(n, deriveSeed(seedFromEnv(), 7), -1000, 1000);
+  SlidingWindow checked(37);
+  vector<int> mins(n), maxs(n);
+  vector<long long> sums(n);
+  checked.pushBatch(data.data(), n, mins.data(), maxs.data(), sums.data());
+  int mismatches = 0;
+  for (size_t i = 0; i < n; i++) {
+    size_t first = i + 1 >= 37 ? i + 1 - 37 : 0;
+    int lo = data[first], hi = data[first];
+    long long s = 0;
+    for (size_t j = first; j <= i; j++) {
+      lo = std::min(lo, data[j]);
+      hi = std::max(hi, data[j]);
+      s += data[j];
+    }
+    mismatches += lo != mins[i] || hi != maxs[i] || s != sums[i];
+  }
+  cout << "Random check (width 37): mismatches " << mismatches << endl;
+
+  // Luong tang dan (truong hop xau: hang doi min giu ca cua so), cua so
+  // rong: Deque cu vs RingDeque
+  const size_t big = 300000, width = 10000;
+  vector<int> stream2(big);
+  fillSorted(stream2.data(), big, deriveSeed(seedFromEnv(), 8), 0, 1 << 30);
+  vector<int> oldMins(big), newMins(big);
+  auto start = chrono::steady_clock::now();
+  slidingMinWithDeque(stream2.data(), big, width, oldMins.data());
+  double oldTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  SlidingWindow fast(width);
+  start = chrono::steady_clock::now();
+  fast.pushBatch(stream2.data(), big, newMins.data(), nullptr, nullptr);
+  double newTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  printf("Sliding min, %zu values, width %zu: vector Deque %.3f s, ring "
+         "buffer %.3f s, same %d\n",
+         big, width, oldTime, newTime, oldMins == newMins);
+}
@@ -0,0 +1,334 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <vector>
+#include "../common/rng.cpp"
+using namespace std;
+
+// Tap so nguyen trong [0, universe) luu bang bitset nhieu tang (kieu
+// van Emde Boas): tang 0 co 1 bit cho moi key, bit i cua tang l + 1 bat khi
+// word i cua tang l khac 0. Voi universe = 2^24 chi co 4 tang, nen tim
+// successor / predecessor chi la vai phep ctz / clz tren vai word.
+// Khi key nam trong mot khoang nho (vd rand() % 100), cach nay gon hon rat
+// nhieu so voi cay con tro (mineven.cpp, bplus_tree.cpp).
+// Them hai tap phu theo tinh chan le: tap cac word cua tang 0 con key chan va
+// tap cac word con key le. mineven / maxodd chi la min / max cua tap phu roi
+// mot phep ctz / clz, ke ca khi key chan (hoac le) rat thua giua nhieu word
+// chi chua key kia.
+
+const uint64_t EVEN_BITS = 0x5555555555555555ull; // bit 0, 2, 4...: key chan
+const uint64_t ODD_BITS = 0xAAAAAAAAAAAAAAAAull;  // bit 1, 3, 5...: key le
+
+struct BitsetSet {
+  long universe;
+  long size;
+  vector<vector<uint64_t>> levels; // levels[0]: bit cua tung key
+  // parityWords[0] / [1]: chi so cac word cua levels[0] co key chan / le
+  // (rong neu tao voi trackParity = false, nhu chinh cac tap phu nay)
+  vector<BitsetSet> parityWords;
+
+  BitsetSet(long universe, bool trackParity = true);
+  bool contains(long key) const;
+  bool insert(long key); // false neu key da co (hoac ngoai khoang)
+  bool erase(long key);  // false neu key khong co
+  long successor(long key) const;   // key nho nhat >= key, -1 neu khong co
+  long predecessor(long key) const; // key lon nhat <= key, -1 neu khong co
+  long min() const { return successor(0); }
+  long max() const { return predecessor(universe - 1); }
+  long mineven() const;
+  long maxodd() const;
+  void print() const;
+
+private:
+  long next(size_t level, long index) const; // bit bat dau tien >= index
+  long prev(size_t level, long index) const; // bit bat cuoi cung <= index
+};
+
+BitsetSet::BitsetSet(long universe, bool trackParity)
+    : universe(universe), size(0) {
+  long bits = universe > 0 ? universe : 1;
+  do {
+    long words = (bits + 63) / 64;
+    levels.push_back(vector<uint64_t>(words, 0));
+    bits = words;
+  } while (bits > 1);
+  if (trackParity) {
+    parityWords.emplace_back(levels[0].size(), false);
+    parityWords.emplace_back(levels[0].size(), false);
+  }
+}
+
+bool BitsetSet::contains(long key) const {
+  if (key < 0 || key >= universe)
+    return false;
+  return levels[0][key >> 6] >> (key & 63) & 1;
+}
+
+bool BitsetSet::insert(long key) {
+  if (key < 0 || key >= universe || contains(key))
+    return false;
+  // word chua co key cung tinh chan le: them word vao tap phu
+  uint64_t parityMask = key & 1 ? ODD_BITS : EVEN_BITS;
+  if (!parityWords.empty() && !(levels[0][key >> 6] & parityMask))
+    parityWords[key & 1].insert(key >> 6);
+  // bat bit o tang duoi; word truoc do bang 0 thi phai bat bit o tang tren
+  long index = key;
+  for (size_t l = 0; l < levels.size(); l++) {
+    uint64_t &word = levels[l][index >> 6];
+    bool wasEmpty = word == 0;
+    word |= 1ull << (index & 63);
+    if (!wasEmpty)
+      break;
+    index >>= 6;
+  }
+  size++;
+  return true;
+}
+
+bool BitsetSet::erase(long key) {
+  if (!contains(key))
+    return false;
+  // tat bit; word thanh 0 thi tat bit tuong ung o tang tren
+  long index = key;
+  for (size_t l = 0; l < levels.size(); l++) {
+    uint64_t &word = levels[l][index >> 6];
+    word &= ~(1ull << (index & 63));
+    if (word != 0)
+      break;
+    index >>= 6;
+  }
+  uint64_t parityMask = key & 1 ? ODD_BITS : EVEN_BITS;
+  if (!parityWords.empty() && !(levels[0][key >> 6] & parityMask))
+    parityWords[key & 1].erase(key >> 6);
+  size--;
+  return true;
+}
+
+long BitsetSet::next(size_t level, long index) const {
+  const vector<uint64_t> &bits = levels[level];
+  long w = index >> 6;
+  if (index < 0 || w >= (long)bits.size())
+    return -1;
+  uint64_t word = bits[w] & (~0ull << (index & 63));
+  if (word)
+    return w * 64 + __builtin_ctzll(word);
+  if (level + 1 == levels.size())
+    return -1;
+  // tang tren cho biet word khac 0 tiep theo
+  w = next(level + 1, w + 1);
+  if (w < 0)
+    return -1;
+  return w * 64 + __builtin_ctzll(bits[w]);
+}
+
+long BitsetSet::prev(size_t level, long index) const {
+  const vector<uint64_t> &bits = levels[level];
+  if (index < 0)
+    return -1;
+  long w = index >> 6;
+  if (w >= (long)bits.size()) {
+    w = bits.size() - 1;
+    index = w * 64 + 63;
+  }
+  uint64_t word = bits[w] & (~0ull >> (63 - (index & 63)));
+  if (word)
+    return w * 64 + 63 - __builtin_clzll(word);
+  if (level + 1 == levels.size())
+    return -1;
+  w = prev(level + 1, w - 1);
+  if (w < 0)
+    return -1;
+  return w * 64 + 63 - __builtin_clzll(bits[w]);
+}
+
+long BitsetSet::successor(long key) const {
+  return next(0, key < 0 ? 0 : key);
+}
+
+long BitsetSet::predecessor(long key) const {
+  return key >= universe ? prev(0, universe - 1) : prev(0, key);
+}
+
+// Word dau tien co key chan (tap phu), loc bit chan bang EVEN_BITS.
+// Tap tao voi trackParity = false thi duyet cac word khac 0 tu dau: cham
+// khi key chan thua giua nhieu word chi co key le.
+long BitsetSet::mineven() const {
+  const vector<uint64_t> &bits = levels[0];
+  if (!parityWords.empty()) {
+    long w = parityWords[0].min();
+    return w < 0 ? -1 : w * 64 + __builtin_ctzll(bits[w] & EVEN_BITS);
+  }
+  for (long w = next(0, 0) >> 6; w >= 0;) {
+    uint64_t even = bits[w] & EVEN_BITS;
+    if (even)
+      return w * 64 + __builtin_ctzll(even);
+    long key = next(0, (w + 1) * 64);
+    w = key < 0 ? -1 : key >> 6;
+  }
+  return -1;
+}
+
+// Nhu mineven nhung lay word cuoi cung co key le, loc bit le bang ODD_BITS
+long BitsetSet::maxodd() const {
+  const vector<uint64_t> &bits = levels[0];
+  if (!parityWords.empty()) {
+    long w = parityWords[1].max();
+    return w < 0 ? -1 : w * 64 + 63 - __builtin_clzll(bits[w] & ODD_BITS);
+  }
+  long key = max();
+  for (long w = key < 0 ? -1 : key >> 6; w >= 0;) {
+    uint64_t odd = bits[w] & ODD_BITS;
+    if (odd)
+      return w * 64 + 63 - __builtin_clzll(odd);
+    key = prev(0, w * 64 - 1);
+    w = key < 0 ? -1 : key >> 6;
+  }
+  return -1;
+}
+
+void BitsetSet::print() const {
+  cout << "{";
+  for (long key = min(); key >= 0; key = successor(key + 1)) {
+    cout << " " << key;
+  }
+  cout << " } size=" << size << " levels=" << levels.size() << endl;
+}
+
+// Chuoi thao tac ngau nhien (key ca ngoai [0, universe)) tren hai BitsetSet,
+// co va khong co tap phu chan le, so voi std::set. Tra ve so lan sai.
+int checkUniverse(long universe, uint64_t seed, int steps) {
+  BitsetSet checked(universe), plain(universe, false);
+  set<long> expected;
+  Rng rng(seed);
+  int mismatches = 0;
+  for (int step = 0; step < steps; step++) {
+    long key = rng.between(-2, universe + 1);
+    int op = rng.between(0, 3);
+    if (op == 0) {
+      bool inserted = key >= 0 && key < universe && expected.insert(key).second;
+      mismatches += checked.insert(key) != inserted;
+      mismatches += plain.insert(key) != inserted;
+    } else if (op == 1) {
+      bool erased = expected.erase(key) > 0;
+      mismatches += checked.erase(key) != erased;
+      mismatches += plain.erase(key) != erased;
+    } else if (op == 2) {
+      auto it = expected.lower_bound(key);
+      long want = it == expected.end() ? -1 : *it;
+      mismatches += checked.successor(key) != want || plain.successor(key) != want;
+    } else {
+      auto it = expected.upper_bound(key);
+      long want = it == expected.begin() ? -1 : *--it;
+      mismatches +=
+          checked.predecessor(key) != want || plain.predecessor(key) != want;
+    }
+    if (step % (universe < 1000 ? 1 : 1000) == 0) {
+      long even = -1, odd = -1;
+      for (long k : expected)
+        if (k % 2 == 0) {
+          even = k;
+          break;
+        }
+      for (auto it = expected.rbegin(); it != expected.rend(); ++it)
+        if (*it % 2 != 0) {
+          odd = *it;
+          break;
+        }
+      mismatches += checked.mineven() != even || checked.maxodd() != odd;
+      mismatches += plain.mineven() != even || plain.maxodd() != odd;
+      mismatches += checked.size != (long)expected.size();
+    }
+  }
+  return mismatches;
+}
+
+int main() {
+  // Giong cac demo cay: 20 key trong [0, 100)
+  BitsetSet small(100);
+  for (int key : uniformKeys(20, seedFromEnv(), 0, 99)) {
+    small.insert(key);
+  }
+  small.print();
+  long result = small.mineven();
+  if (result >= 0) {
+    cout << "Minimum even number: " << result << endl;
+  } else {
+    cout << "No even number found" << endl;
+  }
+  result = small.maxodd();
+  if (result >= 0) {
+    cout << "Maximum odd number: " << result << endl;
+  } else {
+    cout << "No odd number found" << endl;
+  }
+  cout << "Successor of 50: " << small.successor(50)
+       << ", predecessor of 50: " << small.predecessor(50) << endl;
+
+  // Kiem tra ngau nhien voi std::set, ca cac universe sat bien word / tang
+  // (loi lech mot o next / prev va tang tren hay lo ra o day)
+  int mismatches = 0;
+  uint64_t seed = seedFromEnv();
+  for (long universe : {1L, 2L, 63L, 64L, 65L, 127L, 128L, 129L, 4095L, 4096L,
+                        4097L, 262143L, 262144L, 262145L}) {
+    mismatches += checkUniverse(universe, deriveSeed(seed, universe), 20000);
+  }
+  cout << "Random check vs std::set, edge universes: mismatches "
+       << mismatches << endl;
+  mismatches = checkUniverse(1 << 20, deriveSeed(seed, 1), 1000000);
+  cout << "Random check vs std::set, universe 2^20: mismatches " << mismatches
+       << endl;
+
+  // Key le day dac, mot key chan o cuoi: tap phu chan le vs duyet word
+  const long sparseUniverse = 1 << 24;
+  BitsetSet withParity(sparseUniverse), scanOnly(sparseUniverse, false);
+  for (long key = 1; key < sparseUniverse; key += 2) {
+    withParity.insert(key);
+    scanOnly.insert(key);
+  }
+  withParity.insert(sparseUniverse - 2);
+  scanOnly.insert(sparseUniverse - 2);
+  long long parityResult = 0, scanResult = 0;
+  auto start = chrono::steady_clock::now();
+  for (int i = 0; i < 1000; i++)
+    parityResult += withParity.mineven();
+  double parityTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  start = chrono::steady_clock::now();
+  for (int i = 0; i < 1000; i++)
+    scanResult += scanOnly.mineven();
+  double scanTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  cout << "1000 mineven, 2^23 odd keys + 1 even: parity summary " << parityTime
+       << " s, word scan " << scanTime << " s, same "
+       << (parityResult == scanResult) << endl;
+
+  // Successor tren 1e6 key trong [0, 2^24): bitset vs std::set
+  const long bigUniverse = 1 << 24;
+  vector<int> keys =
+      uniformKeys(1000000, deriveSeed(seedFromEnv(), 2), 0, bigUniverse - 1);
+  vector<int> queries =
+      uniformKeys(1000000, deriveSeed(seedFromEnv(), 3), 0, bigUniverse - 1);
+  BitsetSet bits(bigUniverse);
+  set<long> tree;
+  for (int key : keys) {
+    bits.insert(key);
+    tree.insert(key);
+  }
+  long long bitsSum = 0, treeSum = 0;
+  start = chrono::steady_clock::now();
+  for (int q : queries)
+    bitsSum += bits.successor(q);
+  double bitsTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  start = chrono::steady_clock::now();
+  for (int q : queries) {
+    auto it = tree.lower_bound(q);
+    treeSum += it == tree.end() ? -1 : *it;
+  }
+  double treeTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  cout << "1e6 successor queries: bitset " << bitsTime << " s, std::set "
+       << treeTime << " s, same " << (bitsSum == treeSum) << endl;
+  return 0;
+}
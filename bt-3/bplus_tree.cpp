@@ -0,0 +1,736 @@
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include "../common/rng.cpp"
+// Dung lai BinaryTree (mineven.cpp) va SplayTree de kiem tra ket qua
+#define TREE_NO_MAIN
+#include "mineven.cpp"
+#include "splay_tree.cpp"
+using namespace std;
+
+// Node canh dung cache line 64 byte. Node trong = 192 byte: header 4 byte
+// + 15 key lap day line dau, 16 con tro con o 2 line sau, nen moi tang chi
+// cham 2 line (line key va line chua con tro can di). Leaf = 128 byte:
+// header + 27 key + prev/next. Cay 1e6 key cao 6 tang, mot lan tim cham
+// khoang 12 line thay vi ~28 node nhu BinaryTree / SplayTree.
+const int CACHE_LINE = 64;
+const int LEAF_MAX = 27;  // so key toi da trong 1 leaf
+const int INNER_MAX = 15; // so key toi da trong 1 node trong (16 con)
+const int LEAF_MIN = LEAF_MAX / 2;
+const int INNER_MIN = INNER_MAX / 2;
+
+struct BPNode {
+  bool leaf;
+  int16_t count;
+  BPNode(bool leaf) : leaf(leaf), count(0) {}
+};
+
+struct alignas(CACHE_LINE) BPLeaf : BPNode {
+  int keys[LEAF_MAX];
+  BPLeaf *prev, *next;
+  BPLeaf() : BPNode(true), prev(nullptr), next(nullptr) {}
+};
+
+struct alignas(CACHE_LINE) BPInner : BPNode {
+  // keys[i] la key nho nhat cua cay con child[i + 1]
+  int keys[INNER_MAX];
+  BPNode *child[INNER_MAX + 1];
+  BPInner() : BPNode(false) {}
+};
+
+static_assert(sizeof(BPLeaf) == 2 * CACHE_LINE, "BPLeaf phai dung 2 cache line");
+static_assert(sizeof(BPInner) == 3 * CACHE_LINE, "BPInner phai dung 3 cache line");
+static_assert(sizeof(BPNode) + INNER_MAX * sizeof(int) == CACHE_LINE,
+              "header + key cua node trong phai vua line dau");
+
+// Duyet tuan tu tren danh sach leaf; leaf == nullptr la end()
+struct BPIterator {
+  BPLeaf *leaf;
+  int pos;
+  int operator*() const { return leaf->keys[pos]; }
+  BPIterator &operator++();
+  BPIterator &operator--();
+  bool operator==(const BPIterator &o) const {
+    return leaf == o.leaf && (!leaf || pos == o.pos);
+  }
+  bool operator!=(const BPIterator &o) const { return !(*this == o); }
+};
+
+struct BPlusTree {
+  BPNode *root;
+  int size;
+  BPlusTree() : root(nullptr), size(0) {}
+  ~BPlusTree();
+  bool insert(int key);
+  bool remove(int key);
+  bool contains(int key);
+  void containsBatch(const int *keys, size_t n, bool *out);
+  BPIterator lowerBound(int key);
+  BPIterator begin();
+  BPIterator last();
+  BPIterator end() { return BPIterator{nullptr, 0}; }
+  int height();
+  void print();
+};
+
+BPIterator &BPIterator::operator++() {
+  if (++pos >= leaf->count) {
+    leaf = leaf->next;
+    pos = 0;
+  }
+  return *this;
+}
+
+BPIterator &BPIterator::operator--() {
+  if (--pos < 0) {
+    leaf = leaf->prev;
+    pos = leaf ? leaf->count - 1 : 0;
+  }
+  return *this;
+}
+
+// vi tri dau tien co keys[i] >= key. Node chi 1-2 cache line nen dem tuyen
+// tinh khong re nhanh (compiler vector hoa duoc) nhanh hon tim nhi phan,
+// von doan sai nhanh o gan moi buoc.
+int lowerIndex(const int *keys, int count, int key) {
+  int pos = 0;
+  for (int i = 0; i < count; i++)
+    pos += keys[i] < key;
+  return pos;
+}
+
+// vi tri dau tien co keys[i] > key, dung de chon con trong node trong
+int upperIndex(const int *keys, int count, int key) {
+  int pos = 0;
+  for (int i = 0; i < count; i++)
+    pos += keys[i] <= key;
+  return pos;
+}
+
+BPLeaf *findLeaf(BPNode *node, int key) {
+  while (!node->leaf) {
+    BPInner *inner = (BPInner *)node;
+    // nap 2 line con tro con song song voi luc dem key o line dau
+    __builtin_prefetch(inner->child);
+    __builtin_prefetch(inner->child + 8);
+    node = inner->child[upperIndex(inner->keys, inner->count, key)];
+  }
+  return (BPLeaf *)node;
+}
+
+void freeNode(BPNode *node) {
+  if (!node->leaf) {
+    BPInner *inner = (BPInner *)node;
+    for (int i = 0; i <= inner->count; i++) {
+      freeNode(inner->child[i]);
+    }
+    delete inner;
+  } else {
+    delete (BPLeaf *)node;
+  }
+}
+
+BPlusTree::~BPlusTree() {
+  if (root)
+    freeNode(root);
+}
+
+// Chen key vao cay con node. Neu node bi tach thi tra ve node moi ben phai
+// qua splitNode va key phan cach qua splitKey.
+bool insertRec(BPNode *node, int key, BPNode *&splitNode, int &splitKey) {
+  splitNode = nullptr;
+  if (node->leaf) {
+    BPLeaf *leaf = (BPLeaf *)node;
+    int pos = lowerIndex(leaf->keys, leaf->count, key);
+    if (pos < leaf->count && leaf->keys[pos] == key)
+      return false; // key da ton tai, giong SplayTree::insert
+
+    if (leaf->count < LEAF_MAX) {
+      for (int i = leaf->count; i > pos; i--)
+        leaf->keys[i] = leaf->keys[i - 1];
+      leaf->keys[pos] = key;
+      leaf->count++;
+      return true;
+    }
+
+    // leaf day: chia doi LEAF_MAX + 1 key cho 2 leaf
+    int tmp[LEAF_MAX + 1];
+    for (int i = 0, j = 0; i <= LEAF_MAX; i++)
+      tmp[i] = (i == pos) ? key : leaf->keys[j++];
+    BPLeaf *right = new BPLeaf();
+    int half = (LEAF_MAX + 1) / 2;
+    leaf->count = half;
+    right->count = LEAF_MAX + 1 - half;
+    for (int i = 0; i < half; i++)
+      leaf->keys[i] = tmp[i];
+    for (int i = 0; i < right->count; i++)
+      right->keys[i] = tmp[half + i];
+
+    right->next = leaf->next;
+    right->prev = leaf;
+    if (leaf->next)
+      leaf->next->prev = right;
+    leaf->next = right;
+
+    splitNode = right;
+    splitKey = right->keys[0];
+    return true;
+  }
+
+  BPInner *inner = (BPInner *)node;
+  int idx = upperIndex(inner->keys, inner->count, key);
+  BPNode *childSplit;
+  int childKey;
+  if (!insertRec(inner->child[idx], key, childSplit, childKey))
+    return false;
+  if (!childSplit)
+    return true;
+
+  if (inner->count < INNER_MAX) {
+    for (int i = inner->count; i > idx; i--) {
+      inner->keys[i] = inner->keys[i - 1];
+      inner->child[i + 1] = inner->child[i];
+    }
+    inner->keys[idx] = childKey;
+    inner->child[idx + 1] = childSplit;
+    inner->count++;
+    return true;
+  }
+
+  // node trong day: key o giua duoc day len node cha
+  int tmpKeys[INNER_MAX + 1];
+  BPNode *tmpChild[INNER_MAX + 2];
+  for (int i = 0, j = 0; i <= INNER_MAX; i++)
+    tmpKeys[i] = (i == idx) ? childKey : inner->keys[j++];
+  for (int i = 0, j = 0; i <= INNER_MAX + 1; i++)
+    tmpChild[i] = (i == idx + 1) ? childSplit : inner->child[j++];
+
+  int mid = (INNER_MAX + 1) / 2;
+  BPInner *right = new BPInner();
+  inner->count = mid;
+  for (int i = 0; i < mid; i++) {
+    inner->keys[i] = tmpKeys[i];
+    inner->child[i] = tmpChild[i];
+  }
+  inner->child[mid] = tmpChild[mid];
+  right->count = INNER_MAX - mid;
+  for (int i = 0; i < right->count; i++) {
+    right->keys[i] = tmpKeys[mid + 1 + i];
+    right->child[i] = tmpChild[mid + 1 + i];
+  }
+  right->child[right->count] = tmpChild[INNER_MAX + 1];
+
+  splitNode = right;
+  splitKey = tmpKeys[mid];
+  return true;
+}
+
+bool BPlusTree::insert(int key) {
+  if (!root)
+    root = new BPLeaf();
+  BPNode *splitNode;
+  int splitKey;
+  if (!insertRec(root, key, splitNode, splitKey))
+    return false;
+  if (splitNode) {
+    BPInner *newRoot = new BPInner();
+    newRoot->count = 1;
+    newRoot->keys[0] = splitKey;
+    newRoot->child[0] = root;
+    newRoot->child[1] = splitNode;
+    root = newRoot;
+  }
+  size++;
+  return true;
+}
+
+// Con thu idx cua parent bi thieu key: muon tu anh em ben canh, neu khong
+// duoc thi gop voi anh em.
+void fixUnderflow(BPInner *parent, int idx) {
+  BPNode *node = parent->child[idx];
+  BPNode *leftSib = idx > 0 ? parent->child[idx - 1] : nullptr;
+  BPNode *rightSib = idx < parent->count ? parent->child[idx + 1] : nullptr;
+
+  if (node->leaf) {
+    BPLeaf *leaf = (BPLeaf *)node;
+    BPLeaf *l = (BPLeaf *)leftSib, *r = (BPLeaf *)rightSib;
+    if (l && l->count > LEAF_MIN) {
+      for (int i = leaf->count; i > 0; i--)
+        leaf->keys[i] = leaf->keys[i - 1];
+      leaf->keys[0] = l->keys[--l->count];
+      leaf->count++;
+      parent->keys[idx - 1] = leaf->keys[0];
+      return;
+    }
+    if (r && r->count > LEAF_MIN) {
+      leaf->keys[leaf->count++] = r->keys[0];
+      r->count--;
+      for (int i = 0; i < r->count; i++)
+        r->keys[i] = r->keys[i + 1];
+      parent->keys[idx] = r->keys[0];
+      return;
+    }
+    // gop leaf ben phai vao leaf ben trai
+    if (!l) {
+      l = leaf;
+      leaf = r;
+      idx++;
+    }
+    for (int i = 0; i < leaf->count; i++)
+      l->keys[l->count++] = leaf->keys[i];
+    l->next = leaf->next;
+    if (leaf->next)
+      leaf->next->prev = l;
+    delete leaf;
+  } else {
+    BPInner *inner = (BPInner *)node;
+    BPInner *l = (BPInner *)leftSib, *r = (BPInner *)rightSib;
+    if (l && l->count > INNER_MIN) {
+      inner->child[inner->count + 1] = inner->child[inner->count];
+      for (int i = inner->count; i > 0; i--) {
+        inner->keys[i] = inner->keys[i - 1];
+        inner->child[i] = inner->child[i - 1];
+      }
+      inner->keys[0] = parent->keys[idx - 1];
+      inner->child[0] = l->child[l->count];
+      inner->count++;
+      parent->keys[idx - 1] = l->keys[--l->count];
+      return;
+    }
+    if (r && r->count > INNER_MIN) {
+      inner->keys[inner->count] = parent->keys[idx];
+      inner->child[inner->count + 1] = r->child[0];
+      inner->count++;
+      parent->keys[idx] = r->keys[0];
+      for (int i = 0; i < r->count - 1; i++) {
+        r->keys[i] = r->keys[i + 1];
+        r->child[i] = r->child[i + 1];
+      }
+      r->child[r->count - 1] = r->child[r->count];
+      r->count--;
+      return;
+    }
+    if (!l) {
+      l = inner;
+      inner = r;
+      idx++;
+    }
+    l->keys[l->count] = parent->keys[idx - 1];
+    for (int i = 0; i < inner->count; i++) {
+      l->keys[l->count + 1 + i] = inner->keys[i];
+      l->child[l->count + 1 + i] = inner->child[i];
+    }
+    l->child[l->count + 1 + inner->count] = inner->child[inner->count];
+    l->count += inner->count + 1;
+    delete inner;
+  }
+
+  // xoa key phan cach idx - 1 va con idx khoi parent
+  for (int i = idx - 1; i < parent->count - 1; i++) {
+    parent->keys[i] = parent->keys[i + 1];
+    parent->child[i + 1] = parent->child[i + 2];
+  }
+  parent->count--;
+}
+
+bool removeRec(BPNode *node, int key) {
+  if (node->leaf) {
+    BPLeaf *leaf = (BPLeaf *)node;
+    int pos = lowerIndex(leaf->keys, leaf->count, key);
+    if (pos >= leaf->count || leaf->keys[pos] != key)
+      return false;
+    leaf->count--;
+    for (int i = pos; i < leaf->count; i++)
+      leaf->keys[i] = leaf->keys[i + 1];
+    return true;
+  }
+
+  BPInner *inner = (BPInner *)node;
+  int idx = upperIndex(inner->keys, inner->count, key);
+  if (!removeRec(inner->child[idx], key))
+    return false;
+  BPNode *child = inner->child[idx];
+  if (child->count < (child->leaf ? LEAF_MIN : INNER_MIN))
+    fixUnderflow(inner, idx);
+  return true;
+}
+
+bool BPlusTree::remove(int key) {
+  if (!root || !removeRec(root, key))
+    return false;
+  size--;
+  if (!root->leaf && root->count == 0) {
+    BPInner *old = (BPInner *)root;
+    root = old->child[0];
+    delete old;
+  } else if (root->leaf && root->count == 0) {
+    delete (BPLeaf *)root;
+    root = nullptr;
+  }
+  return true;
+}
+
+bool BPlusTree::contains(int key) {
+  if (!root)
+    return false;
+  BPLeaf *leaf = findLeaf(root, key);
+  int pos = lowerIndex(leaf->keys, leaf->count, key);
+  return pos < leaf->count && leaf->keys[pos] == key;
+}
+
+// Nhu findBatch (tree_batch.cpp): BATCH_GROUP key cung di xuong, moi key
+// prefetch node con cua no roi nhuong cho key khac trong luc node dang duoc
+// nap. Moi leaf cung do sau nen ca nhom di xuong tung tang mot luc.
+void BPlusTree::containsBatch(const int *keys, size_t n, bool *out) {
+  BPNode *node[BATCH_GROUP];
+  for (size_t first = 0; first < n; first += BATCH_GROUP) {
+    int group = (int)min<size_t>(BATCH_GROUP, n - first);
+    if (!root) {
+      for (int g = 0; g < group; g++)
+        out[first + g] = false;
+      continue;
+    }
+    for (int g = 0; g < group; g++)
+      node[g] = root;
+    while (!node[0]->leaf) {
+      for (int g = 0; g < group; g++) {
+        BPInner *inner = (BPInner *)node[g];
+        node[g] = inner->child[upperIndex(inner->keys, inner->count, keys[first + g])];
+        const char *line = (const char *)node[g];
+        __builtin_prefetch(line);
+        __builtin_prefetch(line + CACHE_LINE);
+        __builtin_prefetch(line + 2 * CACHE_LINE);
+      }
+    }
+    for (int g = 0; g < group; g++) {
+      BPLeaf *leaf = (BPLeaf *)node[g];
+      int pos = lowerIndex(leaf->keys, leaf->count, keys[first + g]);
+      out[first + g] = pos < leaf->count && leaf->keys[pos] == keys[first + g];
+    }
+  }
+}
+
+BPIterator BPlusTree::lowerBound(int key) {
+  if (!root)
+    return end();
+  BPLeaf *leaf = findLeaf(root, key);
+  int pos = lowerIndex(leaf->keys, leaf->count, key);
+  if (pos == leaf->count)
+    return BPIterator{leaf->next, 0};
+  return BPIterator{leaf, pos};
+}
+
+BPIterator BPlusTree::begin() {
+  if (!root)
+    return end();
+  BPNode *node = root;
+  while (!node->leaf)
+    node = ((BPInner *)node)->child[0];
+  return BPIterator{(BPLeaf *)node, 0};
+}
+
+BPIterator BPlusTree::last() {
+  if (!root)
+    return end();
+  BPNode *node = root;
+  while (!node->leaf)
+    node = ((BPInner *)node)->child[node->count];
+  return BPIterator{(BPLeaf *)node, node->count - 1};
+}
+
+int BPlusTree::height() {
+  int h = 0;
+  for (BPNode *node = root; node; h++) {
+    node = node->leaf ? nullptr : ((BPInner *)node)->child[0];
+  }
+  return h;
+}
+
+void BPlusTree::print() {
+  if (!root) {
+    cout << "Empty tree" << endl;
+    return;
+  }
+  for (BPIterator it = begin(); it != end(); ++it) {
+    cout << *it << " ";
+  }
+  cout << endl;
+  cout << "--------------------------------" << endl;
+}
+
+// Tuong tu mineven / maxodd cua BinaryTree: quet leaf tu hai dau
+BPIterator mineven(BPlusTree &tree) {
+  BPIterator it = tree.begin();
+  while (it != tree.end() && *it % 2 != 0)
+    ++it;
+  return it;
+}
+
+BPIterator maxodd(BPlusTree &tree) {
+  BPIterator it = tree.last();
+  while (it != tree.end() && *it % 2 == 0)
+    --it;
+  return it;
+}
+
+// Kiem tra B+tree voi cac cay co san tren cung chuoi thao tac:
+// - chi insert: contains / mineven / maxodd so voi BinaryTree (findBatch,
+//   mineven, duyet giua)
+// - insert + remove xen ke: contains / remove / mineven / maxodd so voi
+//   SplayTree (search, remove, duyet giua)
+int checkAgainstTrees(uint64_t seed) {
+  int mismatches = 0;
+  const int universe = 5000;
+  BPlusTree bp;
+  BinaryTree binary;
+  vector<int> keys = uniformKeys(20000, deriveSeed(seed, 4), 0, universe - 1);
+  for (int key : keys) {
+    bp.insert(key);
+    binary.insert(key);
+  }
+  vector<int> queries(universe);
+  for (int i = 0; i < universe; i++)
+    queries[i] = i;
+  vector<Node *> found(universe);
+  binary.findBatch(queries.data(), universe, found.data());
+  for (int i = 0; i < universe; i++)
+    mismatches += bp.contains(i) != (found[i] != nullptr);
+  vector<Node *> inorder;
+  collectInorder(binary.root, inorder);
+  Node *even = mineven(binary.root);
+  Node *odd = nullptr;
+  for (size_t i = inorder.size(); i-- > 0 && !odd;)
+    if (inorder[i]->data % 2 != 0)
+      odd = inorder[i];
+  BPIterator it = mineven(bp);
+  mismatches += (it == bp.end()) != !even || (even && *it != even->data);
+  it = maxodd(bp);
+  mismatches += (it == bp.end()) != !odd || (odd && *it != odd->data);
+
+  BPlusTree bp2;
+  SplayTree splay;
+  Rng rng(deriveSeed(seed, 5));
+  for (int step = 0; step < 200000; step++) {
+    int key = rng.between(0, universe - 1);
+    int op = rng.between(0, 3);
+    if (op <= 1) {
+      bp2.insert(key);
+      splay.insert(key);
+    } else if (op == 2 && splay.root) {
+      bool had = splay.search(key) != nullptr;
+      splay.remove(key);
+      mismatches += bp2.remove(key) != had;
+    } else if (splay.root) {
+      mismatches += bp2.contains(key) != (splay.search(key) != nullptr);
+    }
+    if (step % 1000 == 0) {
+      vector<SplayNode *> nodes;
+      collectInorder(splay.root, nodes);
+      int wantEven = -1, wantOdd = -1;
+      for (SplayNode *n : nodes)
+        if (n->key % 2 == 0) {
+          wantEven = n->key;
+          break;
+        }
+      for (size_t i = nodes.size(); i-- > 0;)
+        if (nodes[i]->key % 2 != 0) {
+          wantOdd = nodes[i]->key;
+          break;
+        }
+      it = mineven(bp2);
+      mismatches += (it == bp2.end() ? -1 : *it) != wantEven;
+      it = maxodd(bp2);
+      mismatches += (it == bp2.end() ? -1 : *it) != wantOdd;
+      mismatches += bp2.size != (int)nodes.size();
+    }
+  }
+  return mismatches;
+}
+
+// So cache line mot lan tim cham: moi node trong 2 line (line key + line
+// chua con tro con), leaf thi cac line chua count key dau (dem het count key)
+int linesTouched(BPlusTree &tree, int key) {
+  int lines = 0;
+  BPNode *node = tree.root;
+  while (node && !node->leaf) {
+    BPInner *inner = (BPInner *)node;
+    int idx = upperIndex(inner->keys, inner->count, key);
+    lines += 2;
+    node = inner->child[idx];
+  }
+  if (node)
+    lines += (sizeof(BPNode) + node->count * sizeof(int) + CACHE_LINE - 1) / CACHE_LINE;
+  return lines;
+}
+
+// So node (moi node it nhat 1 line) tim tung key tren cay nhi phan di qua
+template <typename T>
+int nodesVisited(T *node, int T::*key, int k) {
+  int visited = 0;
+  while (node) {
+    visited++;
+    if (node->*key == k)
+      break;
+    node = k < node->*key ? node->left : node->right;
+  }
+  return visited;
+}
+
+// Tim n key ngau nhien (mot nua co trong cay) tren cay n key: ns moi lan tim
+// va so line / node cham trung binh cua tung cach
+void timeLookups(uint64_t seed, int n) {
+  vector<int> keys = uniformKeys(n, deriveSeed(seed, 6), 0, INT_MAX);
+  vector<int> queries = uniformKeys(n, deriveSeed(seed, 7), 0, INT_MAX);
+  for (int i = 0; i < n; i += 2)
+    queries[i] = keys[(i * 7919LL) % n];
+  BPlusTree bp;
+  BinaryTree binary;
+  SplayTree splay;
+  for (int key : keys) {
+    bp.insert(key);
+    binary.insert(key);
+    splay.insert(key);
+  }
+
+  long long lines = 0, binaryNodes = 0, splayNodes = 0;
+  for (int q : queries) {
+    lines += linesTouched(bp, q);
+    binaryNodes += nodesVisited(binary.root, &Node::data, q);
+    splayNodes += nodesVisited(splay.root, &SplayNode::key, q);
+  }
+
+  vector<char> expected(n), got(n);
+  bool same = true;
+  auto report = [&](const char *name, double seconds) {
+    printf("  %-28s %6.1f ns/lookup%s\n", name, seconds * 1e9 / n,
+           got == expected ? "" : "  KHAC KET QUA");
+    same = same && got == expected;
+  };
+  auto start = chrono::steady_clock::now();
+  for (int i = 0; i < n; i++)
+    expected[i] = bp.contains(queries[i]);
+  double seconds =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  printf("%d lookups on %d keys (B+tree height %d):\n", n, n, bp.height());
+  got = expected;
+  report("B+tree contains", seconds);
+
+  unique_ptr<bool[]> batchOut(new bool[n]);
+  start = chrono::steady_clock::now();
+  bp.containsBatch(queries.data(), n, batchOut.get());
+  seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  for (int i = 0; i < n; i++)
+    got[i] = batchOut[i];
+  report("B+tree containsBatch", seconds);
+
+  start = chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    Node *current = binary.root;
+    while (current && current->data != queries[i])
+      current = queries[i] < current->data ? current->left : current->right;
+    got[i] = current != nullptr;
+  }
+  seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  report("BinaryTree one by one", seconds);
+
+  vector<Node *> found(n);
+  start = chrono::steady_clock::now();
+  binary.findBatch(queries.data(), n, found.data());
+  seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  for (int i = 0; i < n; i++)
+    got[i] = found[i] != nullptr;
+  report("BinaryTree findBatch", seconds);
+
+  start = chrono::steady_clock::now();
+  for (int i = 0; i < n; i++)
+    got[i] = splay.peek(queries[i]) != nullptr;
+  seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  report("SplayTree peek", seconds);
+
+  start = chrono::steady_clock::now();
+  for (int i = 0; i < n; i++)
+    got[i] = splay.search(queries[i]) != nullptr;
+  seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  report("SplayTree search", seconds);
+
+  printf("  memory touched per lookup: B+tree %.1f cache lines, BinaryTree %.1f "
+         "nodes, SplayTree %.1f nodes (%zu / %zu byte each)\n",
+         (double)lines / n, (double)binaryNodes / n, (double)splayNodes / n,
+         sizeof(Node), sizeof(SplayNode));
+  printf("  same results: %d\n", same);
+}
+
+int main() {
+  BPlusTree tree;
+  uint64_t seed = seedFromEnv();
+  for (int key : uniformKeys(20, deriveSeed(seed, 1), 0, 99)) {
+    tree.insert(key);
+  }
+  tree.print();
+
+  BPIterator result = mineven(tree);
+  if (result != tree.end()) {
+    cout << "Minimum even number: " << *result << endl;
+  } else {
+    cout << "No even number found" << endl;
+  }
+  result = maxodd(tree);
+  if (result != tree.end()) {
+    cout << "Maximum odd number: " << *result << endl;
+  } else {
+    cout << "No odd number found" << endl;
+  }
+
+  cout << "Keys >= 50: ";
+  for (BPIterator it = tree.lowerBound(50); it != tree.end(); ++it) {
+    cout << *it << " ";
+  }
+  cout << endl;
+  cout << "Keys < 50 (descending): ";
+  BPIterator it = tree.lowerBound(50);
+  it = (it == tree.end()) ? tree.last() : --it;
+  for (; it != tree.end(); --it) {
+    cout << *it << " ";
+  }
+  cout << endl;
+
+  // Cay lon: so node phai di qua moi lan tim kiem
+  BPlusTree big;
+  vector<int> keys = uniformKeys(1000000, deriveSeed(seed, 2), 0, INT_MAX);
+  for (int key : keys) {
+    big.insert(key);
+  }
+  cout << "1e6 random keys: size=" << big.size << " height=" << big.height()
+       << " (binary tree ~ 20+ levels)" << endl;
+  // xoa 3/4 so key (thu tu ngau nhien) de muon / gop node o moi tang
+  sort(keys.begin(), keys.end());
+  keys.erase(unique(keys.begin(), keys.end()), keys.end());
+  Rng rng(deriveSeed(seed, 3));
+  for (size_t i = keys.size() - 1; i > 0; i--) {
+    swap(keys[i], keys[rng.between(0, (int)i)]);
+  }
+  int removed = 0;
+  size_t removeCount = keys.size() / 4 * 3;
+  for (size_t i = 0; i < removeCount; i++) {
+    removed += big.remove(keys[i]);
+  }
+  int wrong = 0, scanned = 0, prev = INT_MIN;
+  for (BPIterator it = big.begin(); it != big.end(); ++it, scanned++) {
+    wrong += scanned > 0 && *it <= prev;
+    prev = *it;
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    wrong += big.contains(keys[i]) != (i >= removeCount);
+  }
+  cout << "Removed " << removed << " keys, size=" << big.size
+       << " height=" << big.height() << " scanned=" << scanned
+       << " wrong=" << wrong << endl;
+
+  cout << "Check vs BinaryTree / SplayTree: mismatches "
+       << checkAgainstTrees(seed) << endl;
+  timeLookups(seed, 1000000);
+  return 0;
+}
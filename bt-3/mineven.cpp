@@ -1,4 +1,11 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include "tree_io.cpp"
+#include "tree_build.cpp"
+#include "tree_batch.cpp"
+#include "../common/rng.cpp"
+#include "../common/temp_path.cpp"
 using namespace std;
 
 struct Node {
@@ -11,7 +18,14 @@ struct BinaryTree {
   Node *root;
   BinaryTree() : root(nullptr) {}
   void insert(int data);
+  void bulkInsert(vector<int> keys, int threads = 0);
+  void mergeSorted(const vector<int> &sorted, int threads = 0);
+  void findBatch(const int *keys, size_t n, Node **out);
   void print();
+  void printCompact(FILE *file = stdout);
+  bool loadCompact(const string &text);
+  bool save(const char *path);
+  bool load(const char *path);
 };
 
 void BinaryTree::insert(int data) {
@@ -38,44 +52,53 @@ void BinaryTree::insert(int data) {
   }
 }
 
-void printTree(Node *root, string prefix = "", bool isLeft = true) {
-  if (!root)
-    return;
-
-  cout << prefix;
-  cout << (isLeft ? "├── " : "└── ");
-  cout << root->data << endl;
+// Them nhieu key cung luc: sort song song roi noi lai thanh cay can bang.
+// threads <= 0: dung tat ca nhan CPU
+void BinaryTree::bulkInsert(vector<int> keys, int threads) {
+  if (threads <= 0)
+    threads = hardwareThreads();
+  parallelSort(keys, threads);
+  mergeSorted(keys, threads);
+}
 
-  if (root->left || root->right) {
-    if (root->left) {
-      printTree(root->left, prefix + (isLeft ? "│   " : "    "), true);
-    } else if (root->right) {
-      cout << prefix << (isLeft ? "│   " : "    ") << "├── "
-           << "null" << endl;
-    }
+// keys phai da duoc sap xep tang dan
+void BinaryTree::mergeSorted(const vector<int> &sorted, int threads) {
+  root = mergeSortedInto(root, sorted, &Node::data,
+                         threads > 0 ? threads : hardwareThreads());
+}
 
-    if (root->right) {
-      printTree(root->right, prefix + (isLeft ? "│   " : "    "), false);
-    }
-  }
+// out[i] la node chua keys[i], hoac nullptr neu khong co
+void BinaryTree::findBatch(const int *keys, size_t n, Node **out) {
+  ::findBatch(root, &Node::data, keys, n, out);
 }
 
 void BinaryTree::print() {
-  if (!root) {
-    cout << "Empty tree" << endl;
-    return;
-  }
-  cout << root->data << endl;
-  if (root->left) {
-    printTree(root->left, "", true);
-  } else if (root->right) {
-    cout << "├── null" << endl;
-  }
-  if (root->right) {
-    printTree(root->right, "", false);
-  }
-  cout << "--------------------------------" << endl;
-};
+  OutBuffer out;
+  dumpTree(root, &Node::data, out);
+}
+
+void BinaryTree::printCompact(FILE *file) {
+  OutBuffer out(file);
+  writePreorder(root, &Node::data, out);
+}
+
+// Chuoi hong thi tra ve false va giu nguyen cay cu
+bool BinaryTree::loadCompact(const string &text) {
+  Node *loaded;
+  if (!readPreorder(text.data(), text.data() + text.size(), loaded))
+    return false;
+  freeTree(root);
+  root = loaded;
+  return true;
+}
+
+bool BinaryTree::save(const char *path) {
+  return saveSnapshot(root, &Node::data, path);
+}
+
+bool BinaryTree::load(const char *path) {
+  return loadSnapshot(path, root);
+}
 
 Node* mineven(Node *root) {
   if (!root) {
@@ -94,12 +117,221 @@ Node* mineven(Node *root) {
   return mineven(root->right);
 }
 
-int main() {
+// Dang gon cua cay thanh chuoi (ghi qua file tam)
+string compactText(BinaryTree &tree) {
+  FILE *file = tmpfile();
+  if (!file) {
+    return "";
+  }
+  tree.printCompact(file);
+  string text(ftell(file), '\0');
+  rewind(file);
+  text.resize(fread(&text[0], 1, text.size(), file));
+  fclose(file);
+  return text;
+}
+
+// Luu snapshot, doc lai (load va MappedTree) roi so ket qua tim kiem voi cay
+// goc; sau do kiem tra file hong bi tu choi. Tra ve so loi.
+int checkSnapshot(uint64_t seed) {
+  string path = tempPath("bt3-snapshot");
+  if (path.empty()) {
+    return 1;
+  }
+  int errors = 0;
+  BinaryTree tree;
+  for (int key : uniformKeys(100000, seed, 0, 199999)) {
+    tree.insert(key);
+  }
+  vector<int> queries(200000);
+  for (int i = 0; i < 200000; i++) {
+    queries[i] = i;
+  }
+  vector<Node *> expected(queries.size()), loadedFound(queries.size());
+  tree.findBatch(queries.data(), queries.size(), expected.data());
+
+  BinaryTree loaded;
+  MappedTree mapped;
+  errors += !tree.save(path.c_str()) || !loaded.load(path.c_str()) ||
+            !mapped.open(path.c_str());
+  errors += compactText(loaded) != compactText(tree);
+  loaded.findBatch(queries.data(), queries.size(), loadedFound.data());
+  for (size_t i = 0; i < queries.size(); i++) {
+    const FlatNode *flat = mapped.find(queries[i]);
+    errors += !expected[i] != !loadedFound[i] || !expected[i] != !flat;
+  }
+  mapped.close();
+
+  // File hong: con phai cua node 1 tro ve chinh no (find cu lap mai mai),
+  // sau do file bi cat cut
+  FlatNode nodes[2];
+  FILE *file = fopen(path.c_str(), "r+b");
+  if (!file || fseek(file, sizeof(SnapshotHeader), SEEK_SET) != 0 ||
+      fread(nodes, sizeof(FlatNode), 2, file) != 2) {
+    errors++;
+  } else {
+    nodes[1].link = (nodes[1].link & HAS_LEFT) | 1;
+    fseek(file, sizeof(SnapshotHeader) + sizeof(FlatNode), SEEK_SET);
+    errors += fwrite(&nodes[1], sizeof(FlatNode), 1, file) != 1;
+  }
+  if (file) {
+    fclose(file);
+  }
+  BinaryTree rejected;
+  errors += rejected.load(path.c_str());
+  // key nho hon goc, lon hon node 1: di trai roi gap lien ket hong o node 1
+  errors += !mapped.open(path.c_str()) || mapped.find(nodes[1].key + 1);
+  mapped.close();
+  errors += truncate(path.c_str(), sizeof(SnapshotHeader) + 5) != 0;
+  errors += rejected.load(path.c_str()) || mapped.open(path.c_str());
+  unlink(path.c_str());
+  return errors;
+}
+
+// Xay cay 2e6 key (co key trung) bang bulkInsert voi 1, 2, 4... thread, so
+// duyet giua voi std::sort; sau do tron them mot lo da sap xep bang
+// mergeSorted. Insert tung key lam moc so sanh.
+void demoBulkBuild(uint64_t seed) {
+  const int n = 2000000;
+  vector<int> keys = uniformKeys(n, seed, 0, n / 2);
+  vector<int> more = uniformKeys(n / 4, deriveSeed(seed, 1), 0, n / 2);
+  sort(more.begin(), more.end());
+  vector<int> expected = keys;
+  sort(expected.begin(), expected.end());
+  vector<int> expectedMerged(expected.size() + more.size());
+  merge(expected.begin(), expected.end(), more.begin(), more.end(),
+        expectedMerged.begin());
+
+  auto sameKeys = [](Node *root, const vector<int> &want) {
+    vector<Node *> nodes;
+    collectInorder(root, nodes);
+    if (nodes.size() != want.size())
+      return false;
+    for (size_t i = 0; i < nodes.size(); i++)
+      if (nodes[i]->data != want[i])
+        return false;
+    return true;
+  };
+
+  BinaryTree single;
+  auto start = chrono::steady_clock::now();
+  for (int key : keys) {
+    single.insert(key);
+  }
+  double insertTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  printf("insert one by one, %d keys: %.3f s, same %d\n", n, insertTime,
+         sameKeys(single.root, expected));
+  freeTree(single.root);
+
+  vector<int> counts;
+  int cores = hardwareThreads();
+  for (int threads = 1; threads < max(cores, 4); threads *= 2) {
+    counts.push_back(threads);
+  }
+  counts.push_back(max(cores, 4));
+  for (int threads : counts) {
+    BinaryTree tree;
+    start = chrono::steady_clock::now();
+    tree.bulkInsert(keys, threads);
+    double buildTime =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    bool built = sameKeys(tree.root, expected);
+    start = chrono::steady_clock::now();
+    tree.mergeSorted(more, threads);
+    double mergeTime =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("bulkInsert %d keys, %d threads: %.3f s, same %d | mergeSorted "
+           "%zu keys: %.3f s, same %d\n",
+           n, threads, buildTime, built, more.size(), mergeTime,
+           sameKeys(tree.root, expectedMerged));
+    freeTree(tree.root);
+  }
+  printf("(%d hardware threads)\n", cores);
+}
+
+// findBatch so voi tim tung key tu goc tren cay n key ngau nhien
+void demoFindBatch(uint64_t seed, int n) {
+  BinaryTree tree;
+  vector<int> keys = uniformKeys(n, seed, 0, 1 << 30);
+  for (int key : keys) {
+    tree.insert(key);
+  }
+  vector<int> queries = uniformKeys(n, deriveSeed(seed, 1), 0, 1 << 30);
+  for (int i = 0; i < n; i += 2) {
+    queries[i] = keys[(i * 7919LL) % n];
+  }
+  vector<Node *> single(n), batch(n);
+  auto start = chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    Node *current = tree.root;
+    while (current && current->data != queries[i]) {
+      current = queries[i] < current->data ? current->left : current->right;
+    }
+    single[i] = current;
+  }
+  double singleTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  start = chrono::steady_clock::now();
+  tree.findBatch(queries.data(), n, batch.data());
+  double batchTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  int mismatches = 0;
+  for (int i = 0; i < n; i++) {
+    mismatches += batch[i] != single[i];
+  }
+  printf("%d lookups on %d keys: one by one %.3f s, findBatch %.3f s, "
+         "mismatches %d\n",
+         n, n, singleTime, batchTime, mismatches);
+}
+
+// Kiem tra va do thoi gian (./mineven --bench): round-trip dang gon tren
+// cay 20 key, snapshot save/load/mmap, bulkInsert / mergeSorted, findBatch
+void runBench(uint64_t seed) {
   BinaryTree tree;
-  // insert 10 random numbers
-  srand(time(nullptr));
-  for (int i = 0; i < 20; i++) {
-    tree.insert(rand() % 100);
+  for (int key : uniformKeys(20, seed, 0, 99)) {
+    tree.insert(key);
+  }
+  // In dang gon, doc lai vao cay moi roi so sanh
+  tree.printCompact();
+  string text = compactText(tree);
+  BinaryTree copy;
+  bool loaded = copy.loadCompact(text);
+  cout << "Compact round-trip: same " << (loaded && compactText(copy) == text)
+       << endl;
+  // Chuoi hong (token la, thieu token, thua token) bi tu choi, copy khong doi
+  int accepted = 0;
+  for (const char *bad : {"50 30 x # #", "50 30 # #", "50 # # 7", ""}) {
+    accepted += copy.loadCompact(bad);
+  }
+  cout << "Compact malformed input: accepted " << accepted << ", copy same "
+       << (compactText(copy) == text) << endl;
+  cout << "Snapshot save/load/mmap check: errors "
+       << checkSnapshot(deriveSeed(seed, 1)) << endl;
+  demoBulkBuild(deriveSeed(seed, 2));
+  demoFindBatch(deriveSeed(seed, 3), 1000000);
+}
+
+// TREE_NO_MAIN: include file nay de dung lai cay (vd: bplus_tree.cpp)
+#ifndef TREE_NO_MAIN
+int main(int argc, char *argv[]) {
+  if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+    runBench(seedFromEnv());
+    return 0;
+  }
+  BinaryTree tree;
+  // ./mineven snapshot.bin: doc cay tu snapshot neu co, neu khong thi tao moi va luu lai
+  if (argc > 1 && tree.load(argv[1])) {
+    cout << "Loaded tree from " << argv[1] << endl;
+  } else {
+    // insert 20 random numbers (seed co dinh, doi bang bien moi truong SEED)
+    vector<int> keys = uniformKeys(20, seedFromEnv(), 0, 99);
+    for (int key : keys) {
+      tree.insert(key);
+    }
+    if (argc > 1 && tree.save(argv[1])) {
+      cout << "Saved tree to " << argv[1] << endl;
+    }
   }
   tree.print();
   Node *result = mineven(tree.root);
@@ -110,3 +342,4 @@ int main() {
   }
   return 0;
 }
+#endif
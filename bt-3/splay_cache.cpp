@@ -0,0 +1,335 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "../common/rng.cpp"
+#include "splay_core.cpp"
+using namespace std;
+
+// Cache key -> value co gioi han dung luong dua tren splay tree: moi lan
+// get/put, key vua dung duoc splay len goc, nen key "nong" luon nam gan goc
+// va tim rat nhanh. Muon bo di phan tu dung lau nhat (LRU) ma khong can
+// danh sach LRU rieng: moi node luu thoi diem dung cuoi (stamp) va moi cay
+// con luu stamp nho nhat cua no (minStamp); tu goc di theo minStamp la toi
+// node cu nhat trong O(do cao).
+//
+// Splay tu duoi len voi con tro cha (splay_core.cpp, dung chung voi
+// splay_rope.cpp); pull cap nhat minStamp sau moi phep xoay. Moi duong di
+// xuong (tim key, tim node cu nhat) deu ket thuc bang splay node cuoi cung,
+// nen moi thao tac deu nam trong chi phi khau hao O(log n) cua splay tree.
+
+struct CacheNode {
+  int key;
+  int value;
+  uint64_t stamp, minStamp;
+  CacheNode *left, *right, *parent;
+  CacheNode(int k, int v, uint64_t t)
+      : key(k), value(v), stamp(t), minStamp(t), left(nullptr),
+        right(nullptr), parent(nullptr) {}
+};
+
+void pull(CacheNode *x) {
+  x->minStamp = x->stamp;
+  if (x->left && x->left->minStamp < x->minStamp)
+    x->minStamp = x->left->minStamp;
+  if (x->right && x->right->minStamp < x->minStamp)
+    x->minStamp = x->right->minStamp;
+}
+
+struct SplayCache {
+  CacheNode *root;
+  size_t size, capacity;
+  uint64_t clock;
+  uint64_t hits, misses, evictions;
+  // get vua truot key missKey: goc la node lien ke cua no, put(missKey) chen
+  // ngay tai goc ma khong tim lai
+  bool missAtRoot;
+  int missKey;
+  SplayCache(size_t capacity)
+      : root(nullptr), size(0), capacity(capacity), clock(0), hits(0),
+        misses(0), evictions(0), missAtRoot(false), missKey(0) {}
+  ~SplayCache();
+  bool get(int key, int &value);
+  void put(int key, int value);
+  void evict();
+  double hitRate() const {
+    return hits + misses ? (double)hits / (hits + misses) : 0;
+  }
+
+private:
+  CacheNode *find(int key); // splay node gap cuoi cung len goc
+  void touch();             // goc vua duoc dung: cap nhat stamp
+  void insertAtRoot(int key, int value);
+  void replaceChild(CacheNode *x, CacheNode *child);
+};
+
+SplayCache::~SplayCache() {
+  vector<CacheNode *> stack;
+  if (root)
+    stack.push_back(root);
+  while (!stack.empty()) {
+    CacheNode *x = stack.back();
+    stack.pop_back();
+    if (x->left)
+      stack.push_back(x->left);
+    if (x->right)
+      stack.push_back(x->right);
+    delete x;
+  }
+}
+
+CacheNode *SplayCache::find(int key) {
+  CacheNode *current = root, *last = nullptr;
+  while (current && current->key != key) {
+    last = current;
+    current = key < current->key ? current->left : current->right;
+  }
+  if (current)
+    last = current;
+  if (last) {
+    splayUp(last);
+    root = last;
+  }
+  return current;
+}
+
+void SplayCache::touch() {
+  root->stamp = ++clock;
+  pull(root);
+}
+
+bool SplayCache::get(int key, int &value) {
+  if (!find(key)) {
+    misses++;
+    missAtRoot = true;
+    missKey = key;
+    return false;
+  }
+  missAtRoot = false;
+  hits++;
+  touch();
+  value = root->value;
+  return true;
+}
+
+void SplayCache::put(int key, int value) {
+  bool absent = missAtRoot && missKey == key;
+  missAtRoot = false;
+  if (!absent && find(key)) {
+    root->value = value;
+    touch();
+    return;
+  }
+  if (capacity == 0)
+    return;
+  // Node moi co stamp moi nhat nen khong bao gio la node bi bo
+  insertAtRoot(key, value);
+  if (size > capacity)
+    evict();
+}
+
+// Goc la node lien ke cua key (vua tim truot): key nam giua goc va cay con
+// mot phia cua goc, nen tach goc ra lam con cua node moi
+void SplayCache::insertAtRoot(int key, int value) {
+  CacheNode *node = new CacheNode(key, value, ++clock);
+  if (root) {
+    if (key < root->key) {
+      node->left = root->left;
+      root->left = nullptr;
+      node->right = root;
+    } else {
+      node->right = root->right;
+      root->right = nullptr;
+      node->left = root;
+    }
+    if (node->left)
+      node->left->parent = node;
+    if (node->right)
+      node->right->parent = node;
+    pull(root);
+    pull(node);
+  }
+  root = node;
+  size++;
+}
+
+// Bo node co stamp nho nhat (dung lau nhat): di theo minStamp toi no, go no
+// ra nhu xoa BST thuong (hai con thi node lon nhat ben trai thay cho no), roi
+// splay node sau nhat bi dung toi (cha cua cho vua go) len goc. Duong di
+// xuong vi vay duoc tra bang mot lan splay, dong thoi minStamp tren duong do
+// duoc tinh lai trong cac phep xoay.
+void SplayCache::evict() {
+  if (!root)
+    return;
+  missAtRoot = false;
+  CacheNode *x = root;
+  uint64_t oldest = root->minStamp;
+  while (x->stamp != oldest) {
+    x = x->left && x->left->minStamp == oldest ? x->left : x->right;
+  }
+
+  CacheNode *fixFrom;
+  if (x->left && x->right) {
+    CacheNode *pred = x->left;
+    while (pred->right)
+      pred = pred->right;
+    if (pred != x->left) {
+      fixFrom = pred->parent;
+      fixFrom->right = pred->left;
+      if (pred->left)
+        pred->left->parent = fixFrom;
+      pred->left = x->left;
+      x->left->parent = pred;
+    } else {
+      fixFrom = pred;
+    }
+    pred->right = x->right;
+    x->right->parent = pred;
+    replaceChild(x, pred);
+  } else {
+    replaceChild(x, x->left ? x->left : x->right);
+    fixFrom = x->parent;
+  }
+  if (fixFrom) {
+    pull(fixFrom);
+    splayUp(fixFrom);
+    root = fixFrom;
+  }
+  delete x;
+  size--;
+  evictions++;
+}
+
+// Dat child vao cho cua x duoi cha cua x (hoac lam goc)
+void SplayCache::replaceChild(CacheNode *x, CacheNode *child) {
+  CacheNode *p = x->parent;
+  if (child)
+    child->parent = p;
+  if (!p)
+    root = child;
+  else if (p->left == x)
+    p->left = child;
+  else
+    p->right = child;
+}
+
+// LRU thong thuong de so sanh: danh sach (moi nhat o dau) + bang bam
+struct ListLru {
+  size_t capacity;
+  list<pair<int, int>> items;
+  unordered_map<int, list<pair<int, int>>::iterator> index;
+  uint64_t hits, misses;
+  ListLru(size_t capacity) : capacity(capacity), hits(0), misses(0) {
+    index.reserve(capacity * 2);
+  }
+  bool get(int key, int &value);
+  void put(int key, int value);
+};
+
+bool ListLru::get(int key, int &value) {
+  auto it = index.find(key);
+  if (it == index.end()) {
+    misses++;
+    return false;
+  }
+  hits++;
+  items.splice(items.begin(), items, it->second);
+  value = it->second->second;
+  return true;
+}
+
+void ListLru::put(int key, int value) {
+  auto it = index.find(key);
+  if (it != index.end()) {
+    it->second->second = value;
+    items.splice(items.begin(), items, it->second);
+    return;
+  }
+  if (capacity == 0)
+    return;
+  if (items.size() >= capacity) {
+    index.erase(items.back().first);
+    items.pop_back();
+  }
+  items.push_front({key, value});
+  index[key] = items.begin();
+}
+
+// Chay chuoi truy cap: get, neu truot thi put (nhu cache doc-qua)
+template <typename Cache>
+double runWorkload(Cache &cache, const vector<int> &keys, long long &checksum) {
+  auto start = chrono::steady_clock::now();
+  checksum = 0;
+  for (int key : keys) {
+    int value;
+    if (!cache.get(key, value)) {
+      value = key ^ 0x5bd1e995;
+      cache.put(key, value);
+    }
+    checksum += value;
+  }
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+  SplayCache cache(3);
+  int value;
+  cache.put(1, 10);
+  cache.put(2, 20);
+  cache.put(3, 30);
+  cache.get(1, value); // 1 moi dung: 2 la cu nhat
+  cache.put(4, 40);    // bo 2
+  cout << "get(2): " << (cache.get(2, value) ? "hit" : "miss") << endl;
+  cout << "get(1): " << (cache.get(1, value) ? "hit " : "miss ") << value
+       << endl;
+  cout << "size=" << cache.size << " hits=" << cache.hits
+       << " misses=" << cache.misses << " evictions=" << cache.evictions
+       << endl;
+
+  // Tai Zipf: hang k xuat hien ~ 1 / k^s; hang duoc bam ra key de key nong
+  // khong nam sat nhau theo thu tu
+  const size_t operations = 2000000;
+  const int universe = 1000000;
+  uint64_t seed = seedFromEnv();
+  vector<int> ranks(operations);
+  for (double skew : {0.8, 0.99, 1.2}) {
+    fillSkewed(ranks.data(), operations, deriveSeed(seed, 1), 0, universe - 1,
+               skew);
+    vector<int> keys(operations);
+    for (size_t i = 0; i < operations; i++)
+      keys[i] = (int)(mix64(ranks[i]) & 0x7fffffff);
+
+    for (size_t capacity : {1000, 100000}) {
+      SplayCache splayCache(capacity);
+      ListLru listCache(capacity);
+      long long splaySum, listSum;
+      double splayTime = runWorkload(splayCache, keys, splaySum);
+      double listTime = runWorkload(listCache, keys, listSum);
+      printf("zipf s=%.2f cap=%6zu: splay %.3f s hit %.4f | list+hash %.3f s "
+             "hit %.4f | same %d\n",
+             skew, capacity, splayTime, splayCache.hitRate(), listTime,
+             (double)listCache.hits / operations,
+             splaySum == listSum && splayCache.hits == listCache.hits);
+    }
+  }
+
+  // Quet vong qua 2 * capacity key lien tiep: moi truy cap deu truot va bo
+  // key nho nhat, cay de lech thanh chuoi. Bo node cu nhat ma khong splay
+  // thi moi lan bo ton O(n); co splay thi van O(log n) khau hao.
+  const int capacity = 100000;
+  vector<int> scan;
+  for (int round = 0; round < 4; round++)
+    for (int key = 0; key < 2 * capacity; key++)
+      scan.push_back(key);
+  SplayCache splayCache(capacity);
+  ListLru listCache(capacity);
+  long long splaySum, listSum;
+  double splayTime = runWorkload(splayCache, scan, splaySum);
+  double listTime = runWorkload(listCache, scan, listSum);
+  printf("scan %zu keys cap=%d: splay %.3f s | list+hash %.3f s | same %d\n",
+         scan.size(), capacity, splayTime, listTime,
+         splaySum == listSum && splayCache.hits == listCache.hits);
+  return 0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+using namespace std;
+
+// Splay tu duoi len cho cac cay co con tro cha, dung chung cho SplayRope
+// (splay_rope.cpp) va SplayCache (splay_cache.cpp). Node T can co left,
+// right, parent va mot ham pull(T *) tinh lai du lieu tong hop cua cay con
+// (size / sum cua rope, minStamp cua cache) sau moi phep xoay.
+// Cay co danh dau lazy phai tu day danh dau tren duong toi x truoc khi splay.
+
+// Xoay x len thay cho cha cua no (x la con trai: xoay phai, nguoc lai xoay trai)
+template <typename T> void rotateUp(T *x) {
+  T *p = x->parent, *g = p->parent;
+  if (p->left == x) {
+    p->left = x->right;
+    if (x->right)
+      x->right->parent = p;
+    x->right = p;
+  } else {
+    p->right = x->left;
+    if (x->left)
+      x->left->parent = p;
+    x->left = p;
+  }
+  p->parent = x;
+  x->parent = g;
+  if (g) {
+    if (g->left == p)
+      g->left = x;
+    else
+      g->right = x;
+  }
+  pull(p);
+  pull(x);
+}
+
+// Dua x len goc cay cua no (node khong co cha)
+template <typename T> void splayUp(T *x) {
+  while (x->parent) {
+    T *p = x->parent, *g = p->parent;
+    if (g) {
+      // Zig-Zig: x va p cung phia thi xoay p truoc; Zig-Zag: xoay x hai lan
+      if ((g->left == p) == (p->left == x))
+        rotateUp(p);
+      else
+        rotateUp(x);
+    }
+    rotateUp(x);
+  }
+}
@@ -0,0 +1,374 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "../common/rng.cpp"
+#include "splay_core.cpp"
+using namespace std;
+
+// Day so (sequence) luu bang splay tree "khoa ngam" (implicit key): vi tri
+// cua mot phan tu chinh la so node dung truoc no trong thu tu giua, tinh tu
+// size cua cac cay con. Moi thao tac theo vi tri (chen, xoa, tach, noi, dao
+// nguoc doan, cong ca doan) deu la O(log n) khau hao, thay vi O(n) nhu chen
+// giua Deque (bt-2/queue.cpp) dung vector.
+//
+// Khac SplayTree (splay_tree.cpp) splay tu goc xuong bang de quy, o day moi
+// node co con tro cha va splay tu duoi len (splay_core.cpp), vi node can
+// splay da tim duoc bang vi tri. Phep dao nguoc va phep cong doan duoc "hoan" (lazy): chi danh
+// dau o goc cay con, day xuong con khi di qua.
+
+struct RopeNode {
+  int value;
+  RopeNode *left, *right, *parent;
+  int size;      // so node trong cay con
+  long long sum; // tong value trong cay con
+  bool rev;      // con cua node nay con phai doi cho (da doi o node nay)
+  int add;       // con cua node nay con phai cong them add (da cong o node nay)
+  RopeNode(int v)
+      : value(v), left(nullptr), right(nullptr), parent(nullptr), size(1),
+        sum(v), rev(false), add(0) {}
+};
+
+int sizeOf(RopeNode *x) { return x ? x->size : 0; }
+long long sumOf(RopeNode *x) { return x ? x->sum : 0; }
+
+// Tinh lai size, sum tu hai con
+void pull(RopeNode *x) {
+  x->size = 1 + sizeOf(x->left) + sizeOf(x->right);
+  x->sum = x->value + sumOf(x->left) + sumOf(x->right);
+}
+
+void applyReverse(RopeNode *x) {
+  if (!x)
+    return;
+  swap(x->left, x->right);
+  x->rev = !x->rev;
+}
+
+void applyAdd(RopeNode *x, int delta) {
+  if (!x)
+    return;
+  x->value += delta;
+  x->sum += (long long)delta * x->size;
+  x->add += delta;
+}
+
+// Day danh dau cua x xuong hai con
+void push(RopeNode *x) {
+  if (x->rev) {
+    applyReverse(x->left);
+    applyReverse(x->right);
+    x->rev = false;
+  }
+  if (x->add) {
+    applyAdd(x->left, x->add);
+    applyAdd(x->right, x->add);
+    x->add = 0;
+  }
+}
+
+// Dua x len goc cay cua no. Danh dau tren duong tu goc toi x phai duoc day
+// xuong truoc khi xoay.
+void splay(RopeNode *x) {
+  vector<RopeNode *> path;
+  for (RopeNode *y = x; y; y = y->parent)
+    path.push_back(y);
+  for (size_t i = path.size(); i-- > 0;)
+    push(path[i]);
+  splayUp(x);
+}
+
+// Node o vi tri k (0..size-1) cua cay goc root, da splay len goc
+RopeNode *nodeAt(RopeNode *root, int k) {
+  RopeNode *x = root;
+  while (true) {
+    push(x);
+    int leftSize = sizeOf(x->left);
+    if (k < leftSize) {
+      x = x->left;
+    } else if (k == leftSize) {
+      break;
+    } else {
+      k -= leftSize + 1;
+      x = x->right;
+    }
+  }
+  splay(x);
+  return x;
+}
+
+// Tach root thanh [0, k) va [k, size)
+void splitAt(RopeNode *root, int k, RopeNode *&left, RopeNode *&right) {
+  if (k <= 0) {
+    left = nullptr;
+    right = root;
+    return;
+  }
+  if (k >= sizeOf(root)) {
+    left = root;
+    right = nullptr;
+    return;
+  }
+  right = nodeAt(root, k);
+  left = right->left;
+  left->parent = nullptr;
+  right->left = nullptr;
+  pull(right);
+}
+
+// Noi hai day: moi phan tu cua a dung truoc b
+RopeNode *concat(RopeNode *a, RopeNode *b) {
+  if (!a)
+    return b;
+  if (!b)
+    return a;
+  a = nodeAt(a, a->size - 1); // phan tu cuoi cua a len goc, khong co con phai
+  a->right = b;
+  b->parent = a;
+  pull(a);
+  return a;
+}
+
+// Xay cay can bang tu values[lo, hi) trong O(n)
+RopeNode *buildRope(const int *values, int lo, int hi) {
+  if (lo >= hi)
+    return nullptr;
+  int mid = lo + (hi - lo) / 2;
+  RopeNode *x = new RopeNode(values[mid]);
+  x->left = buildRope(values, lo, mid);
+  x->right = buildRope(values, mid + 1, hi);
+  if (x->left)
+    x->left->parent = x;
+  if (x->right)
+    x->right->parent = x;
+  pull(x);
+  return x;
+}
+
+struct SplayRope {
+  RopeNode *root;
+  SplayRope() : root(nullptr) {}
+  SplayRope(const vector<int> &values);
+  int size() const { return sizeOf(root); }
+  int get(int pos);
+  void set(int pos, int value);
+  void insert(int pos, int value);
+  void erase(int pos);
+  void append(SplayRope &other);          // noi other vao cuoi, other thanh rong
+  SplayRope split(int pos);               // cat [pos, size) ra day moi
+  void reverse(int lo, int hi);           // dao nguoc doan [lo, hi)
+  void rangeAdd(int lo, int hi, int delta); // cong delta cho doan [lo, hi)
+  long long rangeSum(int lo, int hi);
+  template <typename F> void forEach(F visit);
+  vector<int> toVector();
+  void print();
+
+private:
+  // Tach [lo, hi) ra giua: root chi con hai phan ngoai, tra ve cay giua
+  RopeNode *extract(int lo, int hi, RopeNode *&before, RopeNode *&after);
+};
+
+SplayRope::SplayRope(const vector<int> &values) {
+  root = buildRope(values.data(), 0, values.size());
+}
+
+int SplayRope::get(int pos) {
+  root = nodeAt(root, pos);
+  return root->value;
+}
+
+void SplayRope::set(int pos, int value) {
+  root = nodeAt(root, pos);
+  root->value = value;
+  pull(root);
+}
+
+void SplayRope::insert(int pos, int value) {
+  RopeNode *left, *right;
+  splitAt(root, pos, left, right);
+  RopeNode *x = new RopeNode(value);
+  // x thanh goc: left ben trai, right ben phai
+  x->left = left;
+  x->right = right;
+  if (left)
+    left->parent = x;
+  if (right)
+    right->parent = x;
+  pull(x);
+  root = x;
+}
+
+void SplayRope::erase(int pos) {
+  RopeNode *x = nodeAt(root, pos);
+  RopeNode *left = x->left, *right = x->right;
+  if (left)
+    left->parent = nullptr;
+  if (right)
+    right->parent = nullptr;
+  delete x;
+  root = concat(left, right);
+}
+
+void SplayRope::append(SplayRope &other) {
+  root = concat(root, other.root);
+  other.root = nullptr;
+}
+
+SplayRope SplayRope::split(int pos) {
+  SplayRope rest;
+  splitAt(root, pos, root, rest.root);
+  return rest;
+}
+
+RopeNode *SplayRope::extract(int lo, int hi, RopeNode *&before,
+                             RopeNode *&after) {
+  RopeNode *middle;
+  splitAt(root, hi, before, after);
+  splitAt(before, lo, before, middle);
+  return middle;
+}
+
+void SplayRope::reverse(int lo, int hi) {
+  RopeNode *before, *after;
+  RopeNode *middle = extract(lo, hi, before, after);
+  applyReverse(middle);
+  root = concat(concat(before, middle), after);
+}
+
+void SplayRope::rangeAdd(int lo, int hi, int delta) {
+  RopeNode *before, *after;
+  RopeNode *middle = extract(lo, hi, before, after);
+  applyAdd(middle, delta);
+  root = concat(concat(before, middle), after);
+}
+
+long long SplayRope::rangeSum(int lo, int hi) {
+  RopeNode *before, *after;
+  RopeNode *middle = extract(lo, hi, before, after);
+  long long result = sumOf(middle);
+  root = concat(concat(before, middle), after);
+  return result;
+}
+
+// Duyet theo thu tu trong O(n), day danh dau xuong tren duong di
+template <typename F> void SplayRope::forEach(F visit) {
+  vector<RopeNode *> stack;
+  RopeNode *current = root;
+  while (current || !stack.empty()) {
+    while (current) {
+      push(current);
+      stack.push_back(current);
+      current = current->left;
+    }
+    current = stack.back();
+    stack.pop_back();
+    visit(current->value);
+    current = current->right;
+  }
+}
+
+vector<int> SplayRope::toVector() {
+  vector<int> values;
+  values.reserve(size());
+  forEach([&values](int v) { values.push_back(v); });
+  return values;
+}
+
+void SplayRope::print() {
+  cout << "[";
+  bool first = true;
+  forEach([&first](int v) {
+    cout << (first ? "" : " ") << v;
+    first = false;
+  });
+  cout << "]" << endl;
+}
+
+int main() {
+  vector<int> start;
+  for (int i = 0; i < 10; i++)
+    start.push_back(i);
+  SplayRope rope(start);
+  cout << "Rope: ";
+  rope.print();
+
+  rope.insert(5, 100);
+  cout << "Insert 100 at 5: ";
+  rope.print();
+  rope.erase(0);
+  cout << "Erase at 0: ";
+  rope.print();
+  rope.reverse(2, 8);
+  cout << "Reverse [2, 8): ";
+  rope.print();
+  rope.rangeAdd(0, 5, 10);
+  cout << "Add 10 to [0, 5): ";
+  rope.print();
+  cout << "Sum of [3, 7): " << rope.rangeSum(3, 7) << endl;
+  SplayRope tail = rope.split(6);
+  cout << "Split at 6: ";
+  rope.print();
+  cout << "            ";
+  tail.print();
+  tail.append(rope);
+  cout << "Tail + head: ";
+  tail.print();
+
+  // Kiem tra ngau nhien voi vector
+  Rng rng(seedFromEnv());
+  SplayRope checked;
+  vector<int> expected;
+  int mismatches = 0;
+  for (int step = 0; step < 200000; step++) {
+    int n = expected.size();
+    int op = rng.between(0, 5);
+    if (op <= 1 || n < 2) {
+      int pos = rng.between(0, n);
+      int value = rng.between(-1000, 1000);
+      checked.insert(pos, value);
+      expected.insert(expected.begin() + pos, value);
+    } else if (op == 2) {
+      int pos = rng.between(0, n - 1);
+      checked.erase(pos);
+      expected.erase(expected.begin() + pos);
+    } else {
+      int lo = rng.between(0, n - 1), hi = rng.between(lo + 1, n);
+      if (op == 3) {
+        checked.reverse(lo, hi);
+        std::reverse(expected.begin() + lo, expected.begin() + hi);
+      } else if (op == 4) {
+        int delta = rng.between(-5, 5);
+        checked.rangeAdd(lo, hi, delta);
+        for (int i = lo; i < hi; i++)
+          expected[i] += delta;
+      } else {
+        long long sum = 0;
+        for (int i = lo; i < hi; i++)
+          sum += expected[i];
+        mismatches += checked.rangeSum(lo, hi) != sum;
+      }
+    }
+  }
+  mismatches += checked.toVector() != expected;
+  cout << "Random check, " << expected.size()
+       << " elements: mismatches " << mismatches << endl;
+
+  // Chen vao giua: vector O(n) moi lan, rope O(log n)
+  const int count = 200000;
+  auto begin = chrono::steady_clock::now();
+  vector<int> middleVector;
+  for (int i = 0; i < count; i++)
+    middleVector.insert(middleVector.begin() + middleVector.size() / 2, i);
+  double vectorTime =
+      chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  begin = chrono::steady_clock::now();
+  SplayRope middleRope;
+  for (int i = 0; i < count; i++)
+    middleRope.insert(middleRope.size() / 2, i);
+  double ropeTime =
+      chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  cout << count << " inserts in the middle: vector " << vectorTime
+       << " s, rope " << ropeTime << " s, same result "
+       << (middleRope.toVector() == middleVector) << endl;
+  return 0;
+}
@@ -1,38 +1,50 @@
+#include <chrono>
+#include <cstdio>
 #include <iostream>
+#include "tree_io.cpp"
+#include "tree_batch.cpp"
+#include "../common/rng.cpp"
+#include "../common/temp_path.cpp"
 using namespace std;
 
-struct Node {
+struct SplayNode {
   int key;
-  Node *left, *right;
-  Node(int k) : key(k), left(nullptr), right(nullptr) {}
+  SplayNode *left, *right;
+  SplayNode(int k) : key(k), left(nullptr), right(nullptr) {}
 };
 
 struct SplayTree {
-  Node *root;
+  SplayNode *root;
   SplayTree() : root(nullptr) {}
   void insert(int key);
   void remove(int key);
-  Node* search(int key);
+  SplayNode* search(int key);
+  SplayNode* peek(int key);
+  void searchBatch(const int *keys, size_t n, SplayNode **out, bool restructure = false);
   void print();
+  void printCompact(FILE *file = stdout);
+  bool loadCompact(const string &text);
+  bool save(const char *path);
+  bool load(const char *path);
 };
 
 // Right rotate
-Node *rightRotate(Node *x) {
-  Node *y = x->left;
+SplayNode *rightRotate(SplayNode *x) {
+  SplayNode *y = x->left;
   x->left = y->right;
   y->right = x;
   return y;
 }
 
 // Left rotate
-Node *leftRotate(Node *x) {
-  Node *y = x->right;
+SplayNode *leftRotate(SplayNode *x) {
+  SplayNode *y = x->right;
   x->right = y->left;
   y->left = x;
   return y;
 }
 
-Node *splayUtil(Node *root, int key) {
+SplayNode *splayUtil(SplayNode *root, int key) {
   // Base cases: root is nullptr or key is at root
   if (root == nullptr || root->key == key)
     return root;
@@ -90,10 +102,10 @@ Node *splayUtil(Node *root, int key) {
 }
 
 // Helper function to insert a key (BST insert)
-Node *insertBST(Node *node, int key) {
+SplayNode *insertBST(SplayNode *node, int key) {
   // If tree is empty, return new node
   if (node == nullptr)
-    return new Node(key);
+    return new SplayNode(key);
 
   // Otherwise, recur down the tree
   if (key < node->key)
@@ -111,22 +123,47 @@ void SplayTree::insert(int key) {
   root = splayUtil(root, key);
 }
 
-Node* SplayTree::search(int key) {
+SplayNode* SplayTree::search(int key) {
+  if (!root)
+    return nullptr;
   root = splayUtil(root, key);
   return root->key == key ? root : nullptr;
 }
 
+// Tim kiem khong splay: cay giu nguyen hinh dang
+SplayNode* SplayTree::peek(int key) {
+  SplayNode *current = root;
+  while (current && current->key != key) {
+    current = key < current->key ? current->left : current->right;
+  }
+  return current;
+}
+
+// Mac dinh khong splay, de mot lo hang nghin key khong lam dao lon goc cay.
+// restructure = true thi splay tung key nhu search().
+void SplayTree::searchBatch(const int *keys, size_t n, SplayNode **out, bool restructure) {
+  if (restructure) {
+    for (size_t i = 0; i < n; i++) {
+      out[i] = search(keys[i]);
+    }
+    return;
+  }
+  findBatch(root, &SplayNode::key, keys, n, out);
+}
+
 void SplayTree::remove(int key) {
+  if (!root)
+    return;
   root = splayUtil(root, key);
   if (root->key == key) {
-    Node *left = root->left;
-    Node *right = root->right;
+    SplayNode *left = root->left;
+    SplayNode *right = root->right;
     delete root;
     if (!left) {
       root = right;
     } else {
       // find the largest node in the left subtree
-      Node *largest = left;
+      SplayNode *largest = left;
       while (largest->right) {
         largest = largest->right;
       }
@@ -137,46 +174,89 @@ void SplayTree::remove(int key) {
 }
 
 
-void printTree(Node *root, string prefix = "", bool isLeft = true) {
-  if (!root)
-    return;
+void SplayTree::print() {
+  OutBuffer out;
+  dumpTree(root, &SplayNode::key, out);
+}
 
-  cout << prefix;
-  cout << (isLeft ? "├── " : "└── ");
-  cout << root->key << endl;
+void SplayTree::printCompact(FILE *file) {
+  OutBuffer out(file);
+  writePreorder(root, &SplayNode::key, out);
+}
 
-  if (root->left || root->right) {
-    if (root->left) {
-      printTree(root->left, prefix + (isLeft ? "│   " : "    "), true);
-    } else if (root->right) {
-      cout << prefix << (isLeft ? "│   " : "    ") << "├── "
-           << "null" << endl;
-    }
+// Chuoi hong thi tra ve false va giu nguyen cay cu
+bool SplayTree::loadCompact(const string &text) {
+  SplayNode *loaded;
+  if (!readPreorder(text.data(), text.data() + text.size(), loaded))
+    return false;
+  freeTree(root);
+  root = loaded;
+  return true;
+}
 
-    if (root->right) {
-      printTree(root->right, prefix + (isLeft ? "│   " : "    "), false);
-    }
-  }
+bool SplayTree::save(const char *path) {
+  return saveSnapshot(root, &SplayNode::key, path);
 }
 
-void SplayTree::print() {
-  if (!root) {
-    cout << "Empty tree" << endl;
-    return;
+bool SplayTree::load(const char *path) {
+  return loadSnapshot(path, root);
+}
+
+// So searchBatch voi tim tung key tren cay n key (mot nua query co trong
+// cay): ket qua phai giong peek / search, va in thoi gian cua moi cach
+void demoSearchBatch(uint64_t seed, int n) {
+  SplayTree tree;
+  vector<int> keys = uniformKeys(n, seed, 0, 1 << 30);
+  for (int key : keys) {
+    tree.insert(key);
   }
-  cout << root->key << endl;
-  if (root->left) {
-    printTree(root->left, "", true);
-  } else if (root->right) {
-    cout << "├── null" << endl;
+  vector<int> queries = uniformKeys(n, deriveSeed(seed, 1), 0, 1 << 30);
+  for (int i = 0; i < n; i += 2) {
+    queries[i] = keys[(i * 7919LL) % n];
   }
-  if (root->right) {
-    printTree(root->right, "", false);
+  vector<SplayNode *> single(n), batch(n), splayed(n);
+
+  auto start = chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    single[i] = tree.peek(queries[i]);
   }
-  cout << "--------------------------------" << endl;
-};
+  double peekTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  start = chrono::steady_clock::now();
+  tree.searchBatch(queries.data(), n, batch.data());
+  double batchTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  start = chrono::steady_clock::now();
+  tree.searchBatch(queries.data(), n, splayed.data(), true);
+  double splayTime =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  int mismatches = 0;
+  for (int i = 0; i < n; i++) {
+    mismatches += batch[i] != single[i] || splayed[i] != single[i];
+  }
+  printf("%d lookups on %d keys: peek one by one %.3f s, searchBatch %.3f s, "
+         "searchBatch(restructure) %.3f s, mismatches %d\n",
+         n, n, peekTime, batchTime, splayTime, mismatches);
+
+  // Cay rong: ca hai cach deu tra ve nullptr
+  SplayTree empty;
+  empty.searchBatch(queries.data(), 16, batch.data(), true);
+  empty.searchBatch(queries.data() + 16, 16, batch.data() + 16);
+  mismatches = 0;
+  for (int i = 0; i < 32; i++) {
+    mismatches += batch[i] != nullptr;
+  }
+  cout << "Empty tree searchBatch: mismatches " << mismatches << endl;
+}
 
-int main() {
+// TREE_NO_MAIN: include file nay de dung lai cay (vd: bplus_tree.cpp)
+#ifndef TREE_NO_MAIN
+// ./splay_tree --bench: chi chay demoSearchBatch tren 1e6 key
+int main(int argc, char *argv[]) {
+  if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+    demoSearchBatch(seedFromEnv(), 1000000);
+    return 0;
+  }
   SplayTree tree;
 
   tree.insert(10);
@@ -188,11 +268,21 @@ int main() {
   cout << "Tree after insertions: " << endl;
   tree.print();
 
+  // Luu snapshot, doc lai vao cay moi va tim lai tung key
+  string path = tempPath("splay-snapshot");
+  SplayTree copy;
+  bool loaded = !path.empty() && tree.save(path.c_str()) && copy.load(path.c_str());
+  unlink(path.c_str());
+  for (int key : {10, 20, 25, 30, 40, 50}) {
+    loaded = loaded && copy.peek(key) && copy.search(key);
+  }
+  cout << "Snapshot round-trip: " << (loaded ? "ok" : "failed") << endl;
+
   int input;
   cout << "Enter a key to search: ";
   cin >> input;
   cout << "Searching for " << input << " in tree: " << endl;
-  Node* result = tree.search(input);
+  SplayNode* result = tree.search(input);
   if (result) {
     cout << "Node found: " << result->key << endl;
   } else {
@@ -211,3 +301,4 @@ int main() {
 
   return 0;
 }
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+using namespace std;
+
+// Tim nhieu key cung luc tren cay nhi phan (BinaryTree, SplayTree) ma khong
+// lam thay doi cau truc cay.
+//
+// Tim tung key mot thi moi buoc xuong node con la mot lan cache miss phai
+// doi. O day giu BATCH_GROUP "con tro tim kiem" cung chay: moi vong, moi con
+// tro di xuong mot tang va prefetch node tiep theo cua no, nen trong luc
+// node cua key nay dang duoc nap tu RAM thi CPU xu ly cac key khac.
+// Key nao xong (tim thay hoac gap nullptr) thi nhuong cho key tiep theo.
+const int BATCH_GROUP = 16;
+
+template <typename T>
+void findBatch(T *root, int T::*key, const int *keys, size_t n, T **out) {
+  struct Cursor {
+    T *node;
+    size_t idx;
+  };
+  Cursor cursors[BATCH_GROUP];
+  size_t next = 0;
+  int active = 0;
+  while (active < BATCH_GROUP && next < n) {
+    cursors[active++] = {root, next++};
+  }
+
+  while (active > 0) {
+    for (int s = 0; s < active;) {
+      Cursor &c = cursors[s];
+      T *node = c.node;
+      int k = keys[c.idx];
+      bool done;
+      if (!node) {
+        out[c.idx] = nullptr;
+        done = true;
+      } else if (node->*key == k) {
+        out[c.idx] = node;
+        done = true;
+      } else {
+        node = k < node->*key ? node->left : node->right;
+        c.node = node;
+        if (node)
+          __builtin_prefetch(node);
+        done = false;
+      }
+
+      if (!done) {
+        s++;
+      } else if (next < n) {
+        c = {root, next++};
+        s++;
+      } else {
+        // khong con key moi: lay con tro cuoi cung lap vao cho trong
+        cursors[s] = cursors[--active];
+      }
+    }
+  }
+}
@@ -0,0 +1,179 @@
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "../common/threads.cpp"
+using namespace std;
+
+// Xay dung BinaryTree hang loat thay vi insert tung key tu goc:
+// sap xep song song -> cap phat node song song -> noi node theo kieu chia doi
+// (phan tu giua lam goc), cac cay con o cac tang tren duoc xay tren thread rieng.
+// Quy uoc giong BinaryTree::insert: key bang nhau nam ben phai.
+
+// Duoi nguong nay thi xay tuan tu, tao thread khong con loi
+const size_t PARALLEL_CUTOFF = 1 << 14;
+
+// Merge sort song song: moi thread sort mot doan, sau do tron tung cap doan
+// (cac cap tron song song voi nhau) cho den khi con mot doan.
+void parallelSort(vector<int> &keys, int threads) {
+  size_t n = keys.size();
+  if (threads <= 1 || n < PARALLEL_CUTOFF) {
+    sort(keys.begin(), keys.end());
+    return;
+  }
+  vector<size_t> bounds;
+  for (int i = 0; i <= threads; i++) {
+    bounds.push_back(n * i / threads);
+  }
+
+  vector<thread> workers;
+  for (int i = 0; i < threads; i++) {
+    workers.emplace_back([&keys, &bounds, i] {
+      sort(keys.begin() + bounds[i], keys.begin() + bounds[i + 1]);
+    });
+  }
+  for (thread &t : workers)
+    t.join();
+
+  vector<int> tmp(n);
+  while (bounds.size() > 2) {
+    vector<size_t> next;
+    workers.clear();
+    for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+      size_t lo = bounds[i];
+      size_t mid = bounds[i + 1];
+      size_t hi = i + 2 < bounds.size() ? bounds[i + 2] : mid;
+      next.push_back(lo);
+      workers.emplace_back([&keys, &tmp, lo, mid, hi] {
+        merge(keys.begin() + lo, keys.begin() + mid, keys.begin() + mid,
+              keys.begin() + hi, tmp.begin() + lo);
+      });
+    }
+    next.push_back(n);
+    for (thread &t : workers)
+      t.join();
+    keys.swap(tmp);
+    bounds.swap(next);
+  }
+}
+
+// Chon phan tu giua cua [lo, hi) nhung lui ve key bang no dau tien, de moi
+// key ben trai deu nho hon goc (giong insert: key bang nhau di sang phai).
+template <typename T>
+size_t pickMiddle(T **nodes, size_t lo, size_t hi, int T::*key) {
+  size_t mid = lo + (hi - lo) / 2;
+  int value = nodes[mid]->*key;
+  size_t l = lo, r = mid;
+  while (l < r) {
+    size_t m = l + (r - l) / 2;
+    if (nodes[m]->*key < value)
+      l = m + 1;
+    else
+      r = m;
+  }
+  return l;
+}
+
+// Noi cac node da sap xep thanh cay can bang, dung stack thay cho de quy
+// (nhieu key trung nhau tao thanh chuoi ben phai rat sau).
+template <typename T>
+T *linkSorted(T **nodes, size_t lo, size_t hi, int T::*key) {
+  struct Range {
+    size_t lo, hi;
+    T **slot;
+  };
+  T *root = nullptr;
+  vector<Range> stack;
+  stack.push_back({lo, hi, &root});
+  while (!stack.empty()) {
+    Range r = stack.back();
+    stack.pop_back();
+    if (r.lo >= r.hi) {
+      *r.slot = nullptr;
+      continue;
+    }
+    size_t mid = pickMiddle(nodes, r.lo, r.hi, key);
+    T *node = nodes[mid];
+    *r.slot = node;
+    stack.push_back({r.lo, mid, &node->left});
+    stack.push_back({mid + 1, r.hi, &node->right});
+  }
+  return root;
+}
+
+// depth tang tren cung: cay con trai xay tren thread moi, cay con phai xay
+// tren thread hien tai.
+template <typename T>
+T *linkParallel(T **nodes, size_t lo, size_t hi, int T::*key, int depth) {
+  if (depth <= 0 || hi - lo < PARALLEL_CUTOFF)
+    return linkSorted(nodes, lo, hi, key);
+  size_t mid = pickMiddle(nodes, lo, hi, key);
+  T *node = nodes[mid];
+  thread left([&] { node->left = linkParallel(nodes, lo, mid, key, depth - 1); });
+  node->right = linkParallel(nodes, mid + 1, hi, key, depth - 1);
+  left.join();
+  return node;
+}
+
+template <typename T>
+T *linkBalanced(vector<T *> &nodes, int T::*key, int threads) {
+  int depth = 0;
+  while ((1 << depth) < threads)
+    depth++;
+  return linkParallel(nodes.data(), 0, nodes.size(), key, depth);
+}
+
+// Cap phat node cho day key da sap xep, chia deu cho cac thread
+template <typename T>
+vector<T *> allocNodes(const vector<int> &sorted, int threads) {
+  vector<T *> nodes(sorted.size());
+  if (threads <= 1 || sorted.size() < PARALLEL_CUTOFF) {
+    for (size_t i = 0; i < sorted.size(); i++)
+      nodes[i] = new T(sorted[i]);
+    return nodes;
+  }
+  vector<thread> workers;
+  for (int t = 0; t < threads; t++) {
+    size_t lo = sorted.size() * t / threads;
+    size_t hi = sorted.size() * (t + 1) / threads;
+    workers.emplace_back([&nodes, &sorted, lo, hi] {
+      for (size_t i = lo; i < hi; i++)
+        nodes[i] = new T(sorted[i]);
+    });
+  }
+  for (thread &w : workers)
+    w.join();
+  return nodes;
+}
+
+// Duyet giua (in-order) khong de quy, lay ra cac node cu theo thu tu tang dan
+template <typename T>
+void collectInorder(T *root, vector<T *> &out) {
+  vector<T *> stack;
+  T *current = root;
+  while (current || !stack.empty()) {
+    while (current) {
+      stack.push_back(current);
+      current = current->left;
+    }
+    current = stack.back();
+    stack.pop_back();
+    out.push_back(current);
+    current = current->right;
+  }
+}
+
+// Tron day key da sap xep vao cay co san: dung lai node cu, chi cap phat node
+// cho key moi, roi noi lai toan bo thanh cay can bang trong O(n + m).
+template <typename T>
+T *mergeSortedInto(T *root, const vector<int> &sorted, int T::*key,
+                   int threads) {
+  vector<T *> oldNodes;
+  collectInorder(root, oldNodes);
+  vector<T *> newNodes = allocNodes<T>(sorted, threads);
+  vector<T *> all(oldNodes.size() + newNodes.size());
+  // key bang nhau: node cu dung truoc, nhu khi insert them vao sau
+  merge(oldNodes.begin(), oldNodes.end(), newNodes.begin(), newNodes.end(),
+        all.begin(), [key](T *a, T *b) { return a->*key < b->*key; });
+  return linkBalanced(all, key, threads);
+}
@@ -0,0 +1,349 @@
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "../common/out_buffer.cpp"
+using namespace std;
+
+// Cac ham in / doc cay dung chung cho BinaryTree (mineven.cpp, on-tap) va
+// SplayTree. Node chi can co left, right va mot truong key kieu int, truyen
+// vao qua con tro thanh vien (vd: &Node::data, &SplayNode::key).
+
+// In cay giong het printTree cu, nhung dung stack tu quan ly thay cho de quy
+// va mot chuoi prefix duy nhat: moi frame chi nho do dai prefix cua no.
+template <typename T>
+void dumpTree(T *root, int T::*key, OutBuffer &out) {
+  if (!root) {
+    out.write("Empty tree\n");
+    return;
+  }
+  struct Frame {
+    T *node;
+    size_t prefixLen;
+    bool isLeft;
+  };
+  vector<Frame> stack;
+  string prefix;
+
+  out.putInt(root->*key);
+  out.putChar('\n');
+  if (!root->left && root->right)
+    out.write("├── null\n");
+  if (root->right)
+    stack.push_back({root->right, 0, false});
+  if (root->left)
+    stack.push_back({root->left, 0, true});
+
+  while (!stack.empty()) {
+    Frame f = stack.back();
+    stack.pop_back();
+    prefix.resize(f.prefixLen);
+    out.write(prefix);
+    out.write(f.isLeft ? "├── " : "└── ");
+    out.putInt(f.node->*key);
+    out.putChar('\n');
+
+    T *node = f.node;
+    if (!node->left && !node->right)
+      continue;
+    prefix += f.isLeft ? "│   " : "    ";
+    if (!node->left) {
+      out.write(prefix);
+      out.write("├── null\n");
+    }
+    // day con phai truoc de con trai duoc in truoc
+    if (node->right)
+      stack.push_back({node->right, prefix.size(), false});
+    if (node->left)
+      stack.push_back({node->left, prefix.size(), true});
+  }
+  out.write("--------------------------------\n");
+}
+
+// Dang gon cho may doc: duyet truoc (preorder), '#' la con rong.
+// Vi du: "50 30 # # 70 # #"
+template <typename T>
+void writePreorder(T *root, int T::*key, OutBuffer &out) {
+  vector<T *> stack;
+  stack.push_back(root);
+  while (!stack.empty()) {
+    T *node = stack.back();
+    stack.pop_back();
+    if (!node) {
+      out.write("# ", 2);
+      continue;
+    }
+    out.putInt(node->*key);
+    out.putChar(' ');
+    stack.push_back(node->right);
+    stack.push_back(node->left);
+  }
+  out.putChar('\n');
+}
+
+// Giai phong ca cay bang stack, khong de quy (cay suy bien sau ~n tang)
+template <typename T>
+void freeTree(T *root) {
+  vector<T *> stack;
+  if (root)
+    stack.push_back(root);
+  while (!stack.empty()) {
+    T *node = stack.back();
+    stack.pop_back();
+    if (node->left)
+      stack.push_back(node->left);
+    if (node->right)
+      stack.push_back(node->right);
+    delete node;
+  }
+}
+
+// Doc lai chuoi preorder trong O(n): moi token lap vao "o trong" tren cung
+// cua stack, khong can so sanh key nhu insert. T can constructor T(int key)
+// dat left = right = nullptr.
+// Chuoi hong (token khong phai so hay '#', het chuoi khi con o trong, hoac
+// con token sau khi cay da du) thi giai phong cac node da tao, dat root =
+// nullptr va tra ve false.
+template <typename T>
+bool readPreorder(const char *first, const char *last, T *&root) {
+  root = nullptr;
+  vector<T **> slots;
+  slots.push_back(&root);
+  const char *p = first;
+  auto skipSpace = [&] {
+    while (p < last && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r'))
+      p++;
+  };
+  bool ok = true;
+  while (!slots.empty()) {
+    skipSpace();
+    if (p >= last) {
+      ok = false;
+      break;
+    }
+    T **slot = slots.back();
+    slots.pop_back();
+    if (*p == '#') {
+      *slot = nullptr;
+      p++;
+      continue;
+    }
+    int value;
+    from_chars_result r = from_chars(p, last, value);
+    if (r.ec != errc()) {
+      ok = false;
+      break;
+    }
+    p = r.ptr;
+    T *node = new T(value);
+    *slot = node;
+    slots.push_back(&node->right);
+    slots.push_back(&node->left);
+  }
+  skipSpace();
+  if (!ok || p < last) {
+    freeTree(root);
+    root = nullptr;
+    return false;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Snapshot nhi phan: header + mang FlatNode theo thu tu preorder.
+// Con trai cua node i (neu co) luon la node i + 1, nen moi node chi can luu
+// key va chi so con phai: 8 byte / node. File co the mmap va tim kiem truc
+// tiep ma khong can tao lai node.
+
+const char SNAPSHOT_MAGIC[4] = {'B', 'T', 'S', '1'};
+const uint32_t HAS_LEFT = 0x80000000u;
+
+struct SnapshotHeader {
+  char magic[4];
+  uint32_t count;
+};
+
+struct FlatNode {
+  int32_t key;
+  uint32_t link; // bit 31: co con trai; 31 bit thap: chi so con phai (0 = khong co)
+  bool hasLeft() const { return link & HAS_LEFT; }
+  uint32_t right() const { return link & ~HAS_LEFT; }
+};
+
+template <typename T>
+bool saveSnapshot(T *root, int T::*key, const char *path) {
+  vector<FlatNode> nodes;
+  // moi phan tu: node can ghi va chi so node cha dang cho con phai (-1 neu khong)
+  vector<pair<T *, long>> stack;
+  if (root)
+    stack.push_back({root, -1});
+  while (!stack.empty()) {
+    T *node = stack.back().first;
+    long parent = stack.back().second;
+    stack.pop_back();
+    uint32_t idx = nodes.size();
+    if (parent >= 0)
+      nodes[parent].link |= idx;
+    nodes.push_back({node->*key, node->left ? HAS_LEFT : 0});
+    if (node->right)
+      stack.push_back({node->right, (long)idx});
+    if (node->left)
+      stack.push_back({node->left, -1});
+  }
+
+  FILE *file = fopen(path, "wb");
+  if (!file)
+    return false;
+  SnapshotHeader header;
+  memcpy(header.magic, SNAPSHOT_MAGIC, 4);
+  header.count = nodes.size();
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+            fwrite(nodes.data(), sizeof(FlatNode), nodes.size(), file) ==
+                nodes.size();
+  return fclose(file) == 0 && ok;
+}
+
+// Kiem tra lien ket theo thu tu preorder: node i + 1 la con trai cua i neu
+// i co con trai, neu khong thi no phai la con phai dang cho tren cung stack.
+bool validSnapshot(const FlatNode *nodes, size_t count) {
+  vector<uint32_t> waiting; // cac node co con phai chua gap
+  for (size_t i = 0; i < count; i++) {
+    uint32_t right = nodes[i].right();
+    if (right && (right <= i || right >= count))
+      return false;
+    if (right)
+      waiting.push_back(i);
+    if (nodes[i].hasLeft() || i + 1 == count)
+      continue;
+    // i la la ben trai: node tiep theo phai la con phai dang cho
+    if (waiting.empty() || nodes[waiting.back()].right() != i + 1)
+      return false;
+    waiting.pop_back();
+  }
+  return waiting.empty() && (count == 0 || !nodes[count - 1].hasLeft());
+}
+
+// Dung lai cay trong O(n): cap phat tung node (de remove/delete van dung
+// duoc) roi noi con theo chi so, khong so sanh key.
+// File hong bi tu choi truoc khi cap phat: kich thuoc phai dung bang header,
+// va lien ket phai khop dung thu tu preorder (con phai cua p la node ngay
+// sau cay con trai cua p), nen khong co node nao co hai cha hay tao vong.
+// Doc thanh cong thi cay cu trong root bi giai phong; loi thi root giu nguyen.
+template <typename T>
+bool loadSnapshot(const char *path, T *&root) {
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return false;
+  SnapshotHeader header;
+  vector<FlatNode> flat;
+  bool ok = fseek(file, 0, SEEK_END) == 0;
+  long size = ftell(file);
+  ok = ok && size >= 0 && fseek(file, 0, SEEK_SET) == 0 &&
+       fread(&header, sizeof(header), 1, file) == 1 &&
+       memcmp(header.magic, SNAPSHOT_MAGIC, 4) == 0 &&
+       sizeof(header) + (size_t)header.count * sizeof(FlatNode) ==
+           (size_t)size;
+  if (ok) {
+    flat.resize(header.count);
+    ok = fread(flat.data(), sizeof(FlatNode), flat.size(), file) == flat.size();
+  }
+  fclose(file);
+  if (!ok || !validSnapshot(flat.data(), flat.size()))
+    return false;
+
+  vector<T *> nodes(flat.size());
+  for (size_t i = 0; i < flat.size(); i++) {
+    nodes[i] = new T(flat[i].key);
+  }
+  for (size_t i = 0; i < flat.size(); i++) {
+    if (flat[i].hasLeft())
+      nodes[i]->left = nodes[i + 1];
+    if (flat[i].right())
+      nodes[i]->right = nodes[flat[i].right()];
+  }
+  freeTree(root);
+  root = nodes.empty() ? nullptr : nodes[0];
+  return true;
+}
+
+// Snapshot duoc mmap chi doc: tim kiem ngay tren file, khong deserialize.
+struct MappedTree {
+  const FlatNode *nodes;
+  uint32_t count;
+  void *addr;
+  size_t length;
+  MappedTree() : nodes(nullptr), count(0), addr(nullptr), length(0) {}
+  ~MappedTree() { close(); }
+  bool open(const char *path);
+  void close();
+  const FlatNode *find(int key) const;
+};
+
+bool MappedTree::open(const char *path) {
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) {
+    ::close(fd);
+    return false;
+  }
+  void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED)
+    return false;
+
+  const SnapshotHeader *header = (const SnapshotHeader *)p;
+  if (memcmp(header->magic, SNAPSHOT_MAGIC, 4) != 0 ||
+      sizeof(SnapshotHeader) + (size_t)header->count * sizeof(FlatNode) !=
+          (size_t)st.st_size) {
+    munmap(p, st.st_size);
+    return false;
+  }
+  addr = p;
+  length = st.st_size;
+  count = header->count;
+  nodes = (const FlatNode *)((const char *)p + sizeof(SnapshotHeader));
+  return true;
+}
+
+void MappedTree::close() {
+  if (addr)
+    munmap(addr, length);
+  nodes = nullptr;
+  count = 0;
+  addr = nullptr;
+  length = 0;
+}
+
+// Tim kiem BST tren mang phang: sang trai la i + 1, sang phai la right().
+// File khong duoc kiem tra toan bo khi open (se phai doc het file), nen moi
+// buoc deu kiem tra chi so: luon tang va nam trong mang, vong lap chac chan
+// dung ke ca khi file hong.
+const FlatNode *MappedTree::find(int key) const {
+  uint32_t i = 0;
+  while (i < count) {
+    const FlatNode &node = nodes[i];
+    if (node.key == key)
+      return &node;
+    if (key < node.key) {
+      if (!node.hasLeft())
+        return nullptr;
+      i++;
+    } else {
+      uint32_t right = node.right();
+      if (right <= i || right >= count)
+        return nullptr;
+      i = right;
+    }
+  }
+  return nullptr;
+}
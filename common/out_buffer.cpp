@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Bo dem ghi dung chung (cay trong bt-3, Matrix trong bt-2, Blackjack):
+// gom output vao mot khoi lon, chi goi fwrite khi day hoac khi flush, khong
+// flush theo tung dong nhu endl. So nguyen doi sang chu bang bang 2 chu so
+// ("00".."99") thay vi printf tung so.
+struct OutBuffer {
+  FILE *file;
+  vector<char> buf;
+  size_t len;
+  OutBuffer(FILE *file = stdout, size_t capacity = 1 << 20)
+      : file(file), buf(capacity), len(0) {}
+  ~OutBuffer() { flush(); }
+  void write(const char *s, size_t n);
+  void write(const char *s) { write(s, strlen(s)); }
+  void write(const string &s) { write(s.data(), s.size()); }
+  void putChar(char c);
+  void putInt(long long value, int width = 0); // width: can phai, them space ben trai
+  void flush();
+};
+
+const char DIGIT_PAIRS[201] = "00010203040506070809"
+                              "10111213141516171819"
+                              "20212223242526272829"
+                              "30313233343536373839"
+                              "40414243444546474849"
+                              "50515253545556575859"
+                              "60616263646566676869"
+                              "70717273747576777879"
+                              "80818283848586878889"
+                              "90919293949596979899";
+
+// Chuoi dai hon ca bo dem thi ghi thang, khong qua bo dem
+void OutBuffer::write(const char *s, size_t n) {
+  if (len + n > buf.size()) {
+    flush();
+    if (n > buf.size()) {
+      fwrite(s, 1, n, file);
+      return;
+    }
+  }
+  memcpy(buf.data() + len, s, n);
+  len += n;
+}
+
+void OutBuffer::putChar(char c) {
+  if (len == buf.size())
+    flush();
+  buf[len++] = c;
+}
+
+void OutBuffer::putInt(long long value, int width) {
+  // ghi nguoc tu chu so cuoi vao tmp, moi lan 2 chu so
+  char tmp[24];
+  char *end = tmp + sizeof(tmp), *p = end;
+  unsigned long long v =
+      value < 0 ? 0ull - (unsigned long long)value : value;
+  while (v >= 100) {
+    unsigned int r = v % 100;
+    v /= 100;
+    p -= 2;
+    memcpy(p, DIGIT_PAIRS + 2 * r, 2);
+  }
+  if (v >= 10) {
+    p -= 2;
+    memcpy(p, DIGIT_PAIRS + 2 * v, 2);
+  } else {
+    *--p = '0' + v;
+  }
+  if (value < 0)
+    *--p = '-';
+
+  size_t n = end - p;
+  size_t pad = width > (int)n ? width - n : 0;
+  if (len + pad + n > buf.size()) {
+    flush();
+    if (pad + n > buf.size()) {
+      for (; pad > 0; pad--)
+        fputc(' ', file);
+      fwrite(p, 1, n, file);
+      return;
+    }
+  }
+  memset(buf.data() + len, ' ', pad);
+  memcpy(buf.data() + len + pad, p, n);
+  len += pad + n;
+}
+
+void OutBuffer::flush() {
+  if (len > 0) {
+    fwrite(buf.data(), 1, len, file);
+    len = 0;
+  }
+  fflush(file);
+}
@@ -0,0 +1,196 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "threads.cpp"
+using namespace std;
+
+// Sinh du lieu ngau nhien dung chung cho bt-2, bt-3, on-tap thay cho
+// rand()/srand(time(nullptr)).
+//
+// Bo sinh dua tren bo dem (counter-based): so thu i cua mot seed la
+// mix64(seed + (i + 1) * GOLDEN) (chinh la day splitmix64), khong phu thuoc
+// so thu i - 1. Vi vay:
+//  - cung seed thi lan chay nao cung ra cung du lieu;
+//  - mang lon chia cho nhieu thread, moi thread tu tinh doan cua minh ma ket
+//    qua van giong het khi chay mot thread;
+//  - vong lap khong co phu thuoc giua cac phan tu nen vector hoa duoc.
+
+const uint64_t GOLDEN = 0x9E3779B97F4A7C15ull;
+const uint64_t DEFAULT_SEED = 20241;
+const size_t RNG_PARALLEL_CUTOFF = 1 << 16;
+
+inline uint64_t mix64(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+// So ngau nhien 64 bit thu i cua seed
+inline uint64_t randomAt(uint64_t seed, uint64_t i) {
+  return mix64(seed + (i + 1) * GOLDEN);
+}
+
+// Seed con thu k cua seed (vd: ma tran thu 1, thu 2 trong cung mot demo),
+// cac day con khong trung nhau
+inline uint64_t deriveSeed(uint64_t seed, uint64_t k) {
+  return mix64(seed ^ mix64(k + 0xD1B54A32D192ED03ull));
+}
+
+// Seed mac dinh: bien moi truong SEED neu co, neu khong thi DEFAULT_SEED
+uint64_t seedFromEnv() {
+  const char *s = getenv("SEED");
+  return s ? strtoull(s, nullptr, 10) : DEFAULT_SEED;
+}
+
+// Lay so trong [0, range) tu 32 bit cao cua r bang phep nhan-dich (Lemire),
+// khong chia lay du. Do lech toi da range / 2^32, bo qua duoc voi range nho.
+inline uint32_t scaleTo(uint64_t r, uint32_t range) {
+  return (uint32_t)(((r >> 32) * range) >> 32);
+}
+
+// So thuc trong [0, 1) tu 53 bit cao
+inline double unitAt(uint64_t seed, uint64_t i) {
+  return (randomAt(seed, i) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Dung thay rand() trong cac vong lap tuan tu: moi lan next() tang bo dem
+struct Rng {
+  uint64_t seed;
+  uint64_t counter;
+  Rng(uint64_t seed = DEFAULT_SEED) : seed(seed), counter(0) {}
+  uint64_t next() { return randomAt(seed, counter++); }
+  // so nguyen trong [lo, hi]
+  int between(int lo, int hi) {
+    return lo + (int)scaleTo(next(), (uint32_t)((int64_t)hi - lo + 1));
+  }
+};
+
+// Goi fn(lo, hi) tren threads doan deu nhau cua [0, n)
+template <typename F> void parallelRange(size_t n, int threads, F fn) {
+  if (threads <= 0)
+    threads = hardwareThreads();
+  if (threads == 1 || n < RNG_PARALLEL_CUTOFF) {
+    fn((size_t)0, n);
+    return;
+  }
+  vector<thread> workers;
+  for (int t = 1; t < threads; t++)
+    workers.emplace_back(fn, n * t / threads, n * (t + 1) / threads);
+  fn((size_t)0, n / threads);
+  for (thread &w : workers)
+    w.join();
+}
+
+// Phan phoi deu tren [lo, hi]. first: chi so dau tien trong day cua seed
+// (de nhieu mang nho, vd cac hang ma tran, noi tiep nhau thanh mot day).
+// threads <= 0: dung so nhan CPU.
+void fillUniform(int *out, size_t n, uint64_t seed, int lo, int hi,
+                 int threads = 0, uint64_t first = 0) {
+  uint32_t range = (uint32_t)((int64_t)hi - lo + 1); // 0 nghia la ca 2^32 gia tri
+  parallelRange(n, threads, [=](size_t b, size_t e) {
+    for (size_t i = b; i < e; i++) {
+      uint64_t r = randomAt(seed, first + i);
+      out[i] = range ? lo + (int)scaleTo(r, range) : (int)(r >> 32);
+    }
+  });
+}
+
+// So trong [0, limit) tu r (nhan 64 x 64 lay nua cao)
+inline uint64_t scaleTo64(uint64_t r, uint64_t limit) {
+  return (uint64_t)(((unsigned __int128)r * limit) >> 64);
+}
+
+// Day khong giam trai tu lo den khoang hi: moi buoc tang mot khoang ngau
+// nhien trong [0, 2 * (hi - lo) / n), tinh bang so co dinh diem (24 bit le)
+// nen van dung khi n lon hon hi - lo. Hai luot: luot 1 moi thread cong cac
+// khoang cua doan minh, cong don (prefix) giua cac doan, luot 2 moi thread
+// ghi gia tri tu diem bat dau cua doan minh. Cong so nguyen nen ket qua
+// khong phu thuoc so thread.
+const int GAP_FRACTION_BITS = 24;
+
+void fillSorted(int *out, size_t n, uint64_t seed, int lo, int hi,
+                int threads = 0) {
+  if (n == 0)
+    return;
+  if (threads <= 0)
+    threads = hardwareThreads();
+  if (n < RNG_PARALLEL_CUTOFF)
+    threads = 1;
+  uint64_t span = (uint64_t)((int64_t)hi - lo);
+  uint64_t gapLimit = (2 * span << GAP_FRACTION_BITS) / n + 1;
+
+  vector<uint64_t> start(threads + 1, 0);
+  vector<thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      uint64_t sum = 0;
+      for (size_t i = n * t / threads; i < n * (t + 1) / threads; i++)
+        sum += scaleTo64(randomAt(seed, i), gapLimit);
+      start[t + 1] = sum;
+    });
+  }
+  for (thread &w : workers)
+    w.join();
+  for (int t = 0; t < threads; t++)
+    start[t + 1] += start[t];
+
+  workers.clear();
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      uint64_t sum = start[t];
+      for (size_t i = n * t / threads; i < n * (t + 1) / threads; i++) {
+        sum += scaleTo64(randomAt(seed, i), gapLimit);
+        out[i] = lo + (int)min(sum >> GAP_FRACTION_BITS, span);
+      }
+    });
+  }
+  for (thread &w : workers)
+    w.join();
+}
+
+// Day khong tang tu hi ve lo (anh guong cua fillSorted)
+void fillReverseSorted(int *out, size_t n, uint64_t seed, int lo, int hi,
+                       int threads = 0) {
+  fillSorted(out, n, seed, lo, hi, threads);
+  parallelRange(n, threads, [=](size_t b, size_t e) {
+    for (size_t i = b; i < e; i++)
+      out[i] = (int)((int64_t)lo + hi - out[i]);
+  });
+}
+
+// Phan phoi lech kieu Zipf tren [lo, hi]: gia tri lo + k - 1 (hang k) xuat
+// hien voi tan suat ~ 1 / k^s, tuc lo la "nong" nhat. Dung ham nguoc cua
+// CDF lien tuc cua luat luy thua tren [1, N + 1) nen moi phan tu chi can
+// mot so ngau nhien, khong can bang tra. s > 0; s cang lon cang lech.
+void fillSkewed(int *out, size_t n, uint64_t seed, int lo, int hi, double s,
+                int threads = 0) {
+  double count = (double)((int64_t)hi - lo + 1);
+  double top = count + 1;
+  parallelRange(n, threads, [=](size_t b, size_t e) {
+    for (size_t i = b; i < e; i++) {
+      double u = unitAt(seed, i);
+      double x;
+      if (fabs(s - 1) < 1e-9) {
+        x = pow(top, u);
+      } else {
+        double a = 1 - s;
+        x = pow((pow(top, a) - 1) * u + 1, 1 / a);
+      }
+      int64_t rank = (int64_t)x; // 1..N
+      if (rank > (int64_t)count)
+        rank = (int64_t)count;
+      out[i] = (int)(lo + rank - 1);
+    }
+  });
+}
+
+// Tien loi: tra ve vector
+vector<int> uniformKeys(size_t n, uint64_t seed, int lo, int hi,
+                        int threads = 0) {
+  vector<int> keys(n);
+  fillUniform(keys.data(), n, seed, lo, hi, threads);
+  return keys;
+}
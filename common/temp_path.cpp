@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+using namespace std;
+
+// Tao file tam rong trong $TMPDIR (mac dinh /tmp) va tra ve duong dan, de
+// cac demo ghi / doc file ma khong de lai gi trong thu muc hien tai.
+// Nguoi goi tu xoa bang unlink. Tra ve "" neu khong tao duoc.
+string tempPath(const char *prefix) {
+  const char *dir = getenv("TMPDIR");
+  string path = string(dir && *dir ? dir : "/tmp") + "/" + prefix + "-XXXXXX";
+  int fd = mkstemp(&path[0]);
+  if (fd < 0)
+    return "";
+  close(fd);
+  return path;
+}
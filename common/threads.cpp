@@ -0,0 +1,10 @@
+#pragma once
+#include <thread>
+using namespace std;
+
+// So thread mac dinh cho cac vong lap song song (sinh so, doc file, xay
+// cay...): so nhan CPU, it nhat 1 khi he thong khong cho biet.
+int hardwareThreads() {
+  unsigned n = thread::hardware_concurrency();
+  return n ? n : 1;
+}
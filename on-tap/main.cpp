@@ -1,4 +1,6 @@
 #include <iostream>
+#include "../bt-3/tree_io.cpp"
+#include "../common/rng.cpp"
 using namespace std;
 
 // class Node {
@@ -213,6 +215,8 @@ struct BinaryTree {
   BinaryTree() : root(nullptr) {}
   void insert(int data);
   void print();
+  bool save(const char *path);
+  bool load(const char *path);
 };
 
 void BinaryTree::insert(int data) {
@@ -242,44 +246,18 @@ void BinaryTree::insert(int data) {
   }
 }
 
-void printTree(NODE *root, string prefix = "", bool isLeft = true) {
-  if (!root)
-    return;
-
-  cout << prefix;
-  cout << (isLeft ? "├── " : "└── ");
-  cout << root->data << endl;
-
-  if (root->left || root->right) {
-    if (root->left) {
-      printTree(root->left, prefix + (isLeft ? "│   " : "    "), true);
-    } else if (root->right) {
-      cout << prefix << (isLeft ? "│   " : "    ") << "├── "
-           << "null" << endl;
-    }
+void BinaryTree::print() {
+  OutBuffer out;
+  dumpTree(root, &NODE::data, out);
+}
 
-    if (root->right) {
-      printTree(root->right, prefix + (isLeft ? "│   " : "    "), false);
-    }
-  }
+bool BinaryTree::save(const char *path) {
+  return saveSnapshot(root, &NODE::data, path);
 }
 
-void BinaryTree::print() {
-  if (!root) {
-    cout << "Empty tree" << endl;
-    return;
-  }
-  cout << root->data << endl;
-  if (root->left) {
-    printTree(root->left, "", true);
-  } else if (root->right) {
-    cout << "├── null" << endl;
-  }
-  if (root->right) {
-    printTree(root->right, "", false);
-  }
-  cout << "--------------------------------" << endl;
-};
+bool BinaryTree::load(const char *path) {
+  return loadSnapshot(path, root);
+}
 
 NODE* mineven(NODE *root) {
   if (root == nullptr) {
@@ -301,11 +279,19 @@ NODE* maxodd(NODE *root) {
   return maxodd(root->left);
 }
 
-int main() {
-  srand(time(nullptr));
+int main(int argc, char *argv[]) {
   BinaryTree tree;
-  for (int i = 0; i < 20; i++) {
-    tree.insert(rand() % 100);
+  // ./main snapshot.bin: doc cay tu snapshot neu co, neu khong thi tao moi va luu lai
+  if (argc > 1 && tree.load(argv[1])) {
+    cout << "Loaded tree from " << argv[1] << endl;
+  } else {
+    vector<int> keys = uniformKeys(20, seedFromEnv(), 0, 99);
+    for (int key : keys) {
+      tree.insert(key);
+    }
+    if (argc > 1 && tree.save(argv[1])) {
+      cout << "Saved tree to " << argv[1] << endl;
+    }
   }
   tree.print();
   NODE *result = mineven(tree.root);
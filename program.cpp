@@ -41,88 +41,1132 @@ using namespace std;
 //     return 0;
 // }
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
 #include <iostream>
 #include <numeric>
-#include <random>
 #include <string>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
 #include <vector>
+#include "common/out_buffer.cpp"
+#include "common/threads.cpp"
 
 using namespace std;
 
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256**: 32 byte trang thai, vai ns moi so, thay cho mt19937 (2.5 KB)
+struct Xoshiro256 {
+    uint64_t s[4];
+
+    explicit Xoshiro256(uint64_t seed) {
+        for (int i = 0; i < 4; ++i) s[i] = splitmix64(seed);
+    }
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    uint64_t next() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0]; s[3] ^= s[1]; s[1] ^= s[2]; s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+    // so nguyen deu trong [0, n), phuong phap nhan cua Lemire (khong lech)
+    uint32_t below(uint32_t n) {
+        uint64_t m = (uint64_t)(uint32_t)(next() >> 32) * n;
+        if ((uint32_t)m < n) {
+            uint32_t threshold = (0u - n) % n;
+            while ((uint32_t)m < threshold)
+                m = (uint64_t)(uint32_t)(next() >> 32) * n;
+        }
+        return (uint32_t)(m >> 32);
+    }
+};
+
+uint64_t clockSeed() {
+    return (uint64_t)chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+// Bo bai nam san trong mang co dinh, khong cap phat lai moi van.
+// Fisher-Yates tang dan: moi lan rut moi chon ngau nhien mot la trong phan
+// chua rut, nen chi xao dung so la thuc su duoc chia. Mang luon la mot hoan
+// vi cua 0..51 nen reset() chi can dat lai idx.
 struct Deck {
-    vector<int> cards; // 0..51
+    array<int, 52> cards; // 0..51
     size_t idx = 0;
+    Xoshiro256 rng;
 
-    void reset() {
-        cards.resize(52);
+    explicit Deck(uint64_t seed = clockSeed()) : rng(seed) {
         iota(cards.begin(), cards.end(), 0);
-        auto seed = (uint32_t)chrono::high_resolution_clock::now()
-                        .time_since_epoch().count();
-        mt19937 rng(seed);
-        shuffle(cards.begin(), cards.end(), rng);
-        idx = 0;
     }
-    int draw() { return cards[idx++]; }
+    void reset() { idx = 0; }
+    int draw() {
+        size_t j = idx + rng.below((uint32_t)(52 - idx));
+        swap(cards[idx], cards[j]);
+        return cards[idx++];
+    }
+};
+
+// Chu cua tung la (vd "10♥"), tinh san luc bien dich: in la bai chi la memcpy,
+// khong tao std::string.
+struct CardGlyph {
+    char text[6]; // hang toi da 2 ky tu + chat 3 byte UTF-8
+    uint8_t len;
+};
+
+struct GlyphTable {
+    CardGlyph cards[52];
 };
 
-string cardToString(int c) {
-    static string ranks[] = {"A","2","3","4","5","6","7","8","9","10","J","Q","K"};
-    static string suits[] = {"♠","♥","♦","♣"}; // nếu máy không hiện Unicode, đổi thành "S","H","D","C"
-    int r = c % 13, s = c / 13;
-    return ranks[r] + suits[s];
+constexpr GlyphTable makeGlyphTable() {
+    const char* ranks[] = {"A","2","3","4","5","6","7","8","9","10","J","Q","K"};
+    const char* suits[] = {"♠","♥","♦","♣"}; // nếu máy không hiện Unicode, đổi thành "S","H","D","C"
+    GlyphTable t{};
+    for (int c = 0; c < 52; ++c) {
+        CardGlyph& g = t.cards[c];
+        for (const char* p = ranks[c % 13]; *p; ++p) g.text[g.len++] = *p;
+        for (const char* p = suits[c / 13]; *p; ++p) g.text[g.len++] = *p;
+    }
+    return t;
 }
 
-int rankValue(int c) {
-    int r = c % 13;
-    if (r == 0) return 11;     // A
-    if (r >= 10) return 10;    // J Q K
-    return r + 1;              // 2..10
+constexpr GlyphTable GLYPHS = makeGlyphTable();
+
+void printCard(int c) {
+    cout.write(GLYPHS.cards[c].text, GLYPHS.cards[c].len);
 }
 
-int handValue(const vector<int>& hand) {
-    int sum = 0, aces = 0;
-    for (int c : hand) {
-        sum += rankValue(c);
-        if (c % 13 == 0) aces++;
+// Bo dem van ban: OutBuffer dung chung (common/out_buffer.cpp) them cach in
+// la bai va phan tram
+struct TextBuffer : OutBuffer {
+    using OutBuffer::OutBuffer;
+    void putCard(int c) { write(GLYPHS.cards[c].text, GLYPHS.cards[c].len); }
+    // num / den duoi dang phan tram, 1 chu so thap phan
+    void putPercent(int64_t num, int64_t den) {
+        int64_t x = num * 1000 / den;
+        if (x < 0) { putChar('-'); x = -x; }
+        putInt(x / 10); putChar('.'); putInt(x % 10); putChar('%');
     }
-    while (sum > 21 && aces > 0) { sum -= 10; aces--; } // A: 11 -> 1
-    return sum;
+};
+
+// Bang tra cuu theo ma la (0..51), tinh luc bien dich: khong con % 13 moi la
+struct RankTable {
+    uint8_t points[52]; // A tinh 1, J Q K tinh 10
+    bool ace[52];
+    int8_t hilo[52];    // diem dem Hi-Lo cua la
+};
+
+constexpr RankTable makeRankTable() {
+    RankTable t{};
+    for (int c = 0; c < 52; ++c) {
+        int r = c % 13;
+        t.points[c] = r >= 10 ? 10 : r + 1;
+        t.ace[c] = r == 0;
+        t.hilo[c] = (r >= 1 && r <= 5) ? 1 : (r == 0 || r >= 9) ? -1 : 0;
+    }
+    return t;
+}
+
+constexpr RankTable RANKS = makeRankTable();
+
+int rankValue(int c) {
+    return RANKS.ace[c] ? 11 : RANKS.points[c]; // A = 11
 }
 
-void printHand(const vector<int>& hand, bool hideFirst=false) {
-    for (size_t i = 0; i < hand.size(); ++i) {
+// Trang thai tay bai gon trong 3 byte, cap nhat O(1) moi la:
+// tong cung (A = 1), co A hay khong, so la. A duoc tinh 11 khi khong bi quac,
+// ket qua giong cach cu (cong A = 11 roi tru 10 cho den khi <= 21).
+struct HandState {
+    uint8_t hard = 0;
+    uint8_t hasAce = 0;
+    uint8_t count = 0;
+
+    void add(int c) {
+        hard += RANKS.points[c];
+        hasAce |= RANKS.ace[c];
+        count++;
+    }
+    bool isSoft() const { return hasAce && hard <= 11; }
+    int value() const { return isSoft() ? hard + 10 : hard; }
+};
+
+// Tay bai cho van choi tuong tac: can nho cac la de in ra, nhung nam tren
+// stack. Mot bo 52 la khong the co qua 11 la ma chua quac.
+struct Hand {
+    int cards[12];
+    HandState state;
+
+    void add(int c) {
+        cards[state.count] = c;
+        state.add(c);
+    }
+    int size() const { return state.count; }
+    int value() const { return state.value(); }
+};
+
+void printHand(const Hand& hand, bool hideFirst=false) {
+    for (int i = 0; i < hand.size(); ++i) {
         if (hideFirst && i == 0) cout << "[??] ";
-        else cout << cardToString(hand[i]) << " ";
+        else { printCard(hand.cards[i]); cout << " "; }
+    }
+}
+
+// Shoe nhieu bo bai (6-8 bo nhu o song bai). Giu nguyen qua cac van, chi xao
+// lai khi da chia qua la cat (cut card) = penetration * tong so la. Vi rut
+// theo Fisher-Yates tang dan nen "xao lai" chi la dua idx ve 0, khong phai
+// xao ca 416 la. Sau la cat luon con du la cho mot van (roundReserve), nen
+// khong bao gio phai xao giua van va chia lai la dang nam tren ban.
+struct Shoe {
+    vector<int> cards; // moi la luu ma 0..51, cap phat mot lan
+    size_t idx = 0;
+    size_t cutCard;
+    int decks;
+    int runningCount = 0; // dem Hi-Lo: 2-6 la +1, 7-9 la 0, 10-A la -1
+    uint64_t shuffles = 0;
+    Xoshiro256 rng;
+
+    explicit Shoe(int decks = 6, double penetration = 0.75, uint64_t seed = clockSeed())
+        : cards(52 * decks), decks(decks), rng(seed) {
+        for (size_t i = 0; i < cards.size(); ++i) cards[i] = i % 52;
+        size_t reserve = roundReserve(decks);
+        cutCard = penetration > 0 ? (size_t)(penetration * cards.size()) : 0;
+        if (cutCard > cards.size() - reserve) cutCard = cards.size() - reserve;
+    }
+    // So la toi da mot van can: nguoi choi chi rut khi tong cung <= 20, nha
+    // cai khi < 17, nen moi tay co toi da so la nho nhat cua shoe cong lai
+    // khong qua nguong do, them 1 la cuoi (6 bo: 21 + 17 la, 1 bo: 11 + 10)
+    static size_t roundReserve(int decks) {
+        size_t n = 0;
+        for (int limit : {20, 16}) {
+            int sum = 0;
+            for (int points = 1; points <= 10; ++points) // A, 2..9, 10/J/Q/K
+                for (int k = (points == 10 ? 16 : 4) * decks; k > 0 && sum + points <= limit; --k) {
+                    sum += points;
+                    n++;
+                }
+            n++;
+        }
+        return n;
+    }
+    void shuffle() { idx = 0; runningCount = 0; shuffles++; }
+    bool needsShuffle() const { return idx >= cutCard; }
+    // goi dau moi van: chi xao khi da qua la cat
+    void reset() { if (needsShuffle()) shuffle(); }
+    int draw() {
+        assert(idx < cards.size() && "van choi vuot qua roundReserve");
+        size_t j = idx + rng.below((uint32_t)(cards.size() - idx));
+        swap(cards[idx], cards[j]);
+        int c = cards[idx++];
+        runningCount += RANKS.hilo[c];
+        return c;
+    }
+    size_t remaining() const { return cards.size() - idx; }
+    double trueCount() const { return runningCount * 52.0 / max<size_t>(remaining(), 1); }
+};
+
+// ===== Giai chinh xac bang quy hoach dong co nho =====
+// Tinh EV chinh xac cho luat cua Deck (1 bo 52 la, chi hit/stand, Blackjack
+// tu nhien ket thuc van, nha cai rut den >= 17) theo thanh phan bo bai con
+// lai (composition-dependent), khong mo phong.
+//
+// Hang (rank) danh so 0 = A, 1..8 = 2..9, 9 = 10/J/Q/K. Bo bai con lai la so
+// la moi hang, nen vao 50 bit (5 bit / hang) de lam khoa nho.
+// La up cua nha cai da biet; la up la A/10 thi van chi tiep tuc khi nha cai
+// KHONG co Blackjack, nen la up con lai (chua lat) bi loai tru hang "xau" do:
+// moi xac suat rut la deu duoc dieu kien hoa theo su kien nay.
+
+struct Composition {
+    uint8_t n[10];
+    int total;
+
+    uint64_t key() const {
+        uint64_t k = 0;
+        for (int r = 0; r < 10; ++r) k = (k << 5) | n[r];
+        return k;
+    }
+    void take(int r) { n[r]--; total--; }
+    void put(int r) { n[r]++; total++; }
+};
+
+// Bang chien luoc do solver tao: strategyHit[tong][mem][up] = true neu nen rut.
+// mem = 1 khi tay bai dang tinh A = 11. up la hang cua la ngua nha cai.
+bool strategyHit[22][2][10];
+
+struct BlackjackSolver {
+    typedef array<double, 6> DealerDist; // tong cuoi 17..21, [5] = quac
+    unordered_map<uint64_t, DealerDist> dealerMemo;
+    unordered_map<uint64_t, pair<double, double>> playerMemo; // (stand, hit)
+    double standSum[22][2][10], hitSum[22][2][10];
+    double gameEV = 0;
+
+    static int badRank(int up) { return up == 0 ? 9 : up == 9 ? 0 : -1; }
+    // xac suat la up con lai khong tao Blackjack voi la up
+    static double holeOk(const Composition& c, int up) {
+        int bad = badRank(up);
+        return bad < 0 ? 1.0 : 1.0 - (double)c.n[bad] / c.total;
+    }
+    static int value(int hard, bool ace) { return ace && hard <= 11 ? hard + 10 : hard; }
+
+    // Phan bo tong cuoi cua nha cai khi dang co (hard, ace) va bo bai c
+    const DealerDist& dealerFinal(Composition& c, int hard, bool ace) {
+        uint64_t k = (c.key() << 6) | (hard << 1) | ace;
+        auto it = dealerMemo.find(k);
+        if (it != dealerMemo.end()) return it->second;
+        DealerDist dist{};
+        for (int r = 0; r < 10; ++r) {
+            if (!c.n[r]) continue;
+            double p = (double)c.n[r] / c.total;
+            int h = hard + r + 1;
+            bool a = ace || r == 0;
+            int v = value(h, a);
+            if (v >= 17) {
+                dist[v > 21 ? 5 : v - 17] += p;
+            } else {
+                c.take(r);
+                const DealerDist& sub = dealerFinal(c, h, a);
+                for (int i = 0; i < 6; ++i) dist[i] += p * sub[i];
+                c.put(r);
+            }
+        }
+        return dealerMemo[k] = dist;
+    }
+
+    // Phan bo tong cuoi cua nha cai voi la up, biet rang khong co Blackjack
+    DealerDist dealerGivenUp(Composition& c, int up) {
+        DealerDist dist{};
+        int bad = badRank(up);
+        int okTotal = c.total - (bad >= 0 ? c.n[bad] : 0);
+        for (int r = 0; r < 10; ++r) {
+            if (r == bad || !c.n[r]) continue;
+            double p = (double)c.n[r] / okTotal;
+            int h = up + 1 + r + 1;
+            bool a = up == 0 || r == 0;
+            c.take(r);
+            if (value(h, a) >= 17) {
+                int v = value(h, a);
+                dist[v > 21 ? 5 : v - 17] += p;
+            } else {
+                const DealerDist& sub = dealerFinal(c, h, a);
+                for (int i = 0; i < 6; ++i) dist[i] += p * sub[i];
+            }
+            c.put(r);
+        }
+        return dist;
+    }
+
+    double standEV(Composition& c, int pv, int up) {
+        DealerDist d = dealerGivenUp(c, up);
+        double ev = d[5];
+        for (int i = 0; i < 5; ++i) {
+            int dv = 17 + i;
+            if (pv > dv) ev += d[i];
+            else if (pv < dv) ev -= d[i];
+        }
+        return ev;
+    }
+
+    // EV (dung, rut) cua tay bai hien tai. Tay bai = bo day du - c - la up,
+    // nen (c, up) xac dinh duy nhat trang thai.
+    pair<double, double> decide(Composition& c, HandState hand, int up) {
+        uint64_t k = (c.key() << 4) | up;
+        auto it = playerMemo.find(k);
+        if (it != playerMemo.end()) return it->second;
+        double stand = standEV(c, hand.value(), up);
+        double hit = 0, ok = holeOk(c, up);
+        for (int r = 0; r < 10; ++r) {
+            if (!c.n[r]) continue;
+            double p = (double)c.n[r] / c.total;
+            c.take(r);
+            double w = p * holeOk(c, up) / ok;
+            HandState next = hand;
+            next.hard += r + 1;
+            next.hasAce |= r == 0;
+            next.count++;
+            int v = next.value();
+            if (v > 21) hit -= w;
+            else if (v == 21) hit += w * standEV(c, 21, up); // dat 21 thi tu dung
+            else {
+                pair<double, double> sub = decide(c, next, up);
+                hit += w * max(sub.first, sub.second);
+            }
+            c.put(r);
+        }
+        return playerMemo[k] = make_pair(stand, hit);
+    }
+
+    // Di theo duong choi toi uu, cong don EV co trong so xac suat di toi, de
+    // rut ra bang chien luoc chi theo (tong, mem, la up).
+    void accumulate(Composition& c, HandState hand, int up, double reach) {
+        pair<double, double> ev = decide(c, hand, up);
+        int v = hand.value(), soft = hand.isSoft();
+        standSum[v][soft][up] += reach * ev.first;
+        hitSum[v][soft][up] += reach * ev.second;
+        if (ev.second <= ev.first) return;
+        double ok = holeOk(c, up);
+        for (int r = 0; r < 10; ++r) {
+            if (!c.n[r]) continue;
+            double p = (double)c.n[r] / c.total;
+            c.take(r);
+            HandState next = hand;
+            next.hard += r + 1;
+            next.hasAce |= r == 0;
+            next.count++;
+            if (next.value() < 21)
+                accumulate(c, next, up, reach * p * holeOk(c, up) / ok);
+            c.put(r);
+        }
+    }
+
+    static Composition fullDeck() {
+        Composition c;
+        for (int r = 0; r < 9; ++r) c.n[r] = 4;
+        c.n[9] = 16;
+        c.total = 52;
+        return c;
+    }
+
+    // Duyet moi cach chia (la nguoi choi 1, 2, la up) voi xac suat chinh xac
+    void solve() {
+        memset(standSum, 0, sizeof(standSum));
+        memset(hitSum, 0, sizeof(hitSum));
+        gameEV = 0;
+        Composition c = fullDeck();
+        for (int p1 = 0; p1 < 10; ++p1) {
+            double pr1 = (double)c.n[p1] / c.total;
+            c.take(p1);
+            for (int p2 = 0; p2 < 10; ++p2) {
+                if (!c.n[p2]) continue;
+                double pr2 = pr1 * c.n[p2] / c.total;
+                c.take(p2);
+                for (int up = 0; up < 10; ++up) {
+                    if (!c.n[up]) continue;
+                    double pr = pr2 * c.n[up] / c.total;
+                    c.take(up);
+                    double dealerBJ = 1.0 - holeOk(c, up);
+                    bool natural = (p1 == 0 && p2 == 9) || (p1 == 9 && p2 == 0);
+                    if (natural) {
+                        gameEV += pr * (1.0 - dealerBJ);
+                    } else {
+                        HandState hand;
+                        hand.hard = p1 + p2 + 2;
+                        hand.hasAce = p1 == 0 || p2 == 0;
+                        hand.count = 2;
+                        pair<double, double> ev = decide(c, hand, up);
+                        gameEV += pr * (-dealerBJ + (1.0 - dealerBJ) * max(ev.first, ev.second));
+                        accumulate(c, hand, up, pr * (1.0 - dealerBJ));
+                    }
+                    c.put(up);
+                }
+                c.put(p2);
+            }
+            c.put(p1);
+        }
+
+        for (int v = 0; v < 22; ++v)
+            for (int s = 0; s < 2; ++s)
+                for (int up = 0; up < 10; ++up) {
+                    bool seen = standSum[v][s][up] != 0 || hitSum[v][s][up] != 0;
+                    strategyHit[v][s][up] = seen ? hitSum[v][s][up] > standSum[v][s][up]
+                                                 : v <= 11;
+                }
     }
+};
+
+// ===== Mo phong hang loat (khong nhap/xuat trong vong lap) =====
+// Luat giong het van choi tuong tac o duoi: Blackjack tu nhien ket thuc van,
+// nguoi choi tu dung khi dat 21, nha cai rut den khi >= 17.
+
+struct SimStats {
+    uint64_t hands = 0;
+    uint64_t wins = 0, losses = 0, pushes = 0;
+    uint64_t playerBusts = 0, dealerBusts = 0;
+    uint64_t playerBlackjacks = 0, dealerBlackjacks = 0;
+    int64_t net = 0;   // thang +1, thua -1, hoa 0
+    int64_t netSq = 0; // tong binh phuong ket qua, de tinh phuong sai
+    // chi khi choi bang Shoe: so lan xao lai va true count Hi-Lo dau moi van,
+    // trueCounts[i] dem cac van co floor(true count) = i - TRUE_COUNT_MAX (chan 2 dau)
+    static const int TRUE_COUNT_MAX = 6;
+    uint64_t shuffles = 0;
+    uint64_t trueCounts[2 * TRUE_COUNT_MAX + 1] = {};
+
+    void merge(const SimStats& o) {
+        hands += o.hands;
+        wins += o.wins; losses += o.losses; pushes += o.pushes;
+        playerBusts += o.playerBusts; dealerBusts += o.dealerBusts;
+        playerBlackjacks += o.playerBlackjacks; dealerBlackjacks += o.dealerBlackjacks;
+        net += o.net; netSq += o.netSq;
+        shuffles += o.shuffles;
+        for (int i = 0; i <= 2 * TRUE_COUNT_MAX; ++i) trueCounts[i] += o.trueCounts[i];
+    }
+};
+
+// Ghi true count dau van; bo 52 la xao moi van thi khong co gi de dem
+void noteRound(const Deck& /*deck*/, SimStats& /*st*/) {}
+void noteRound(const Shoe& shoe, SimStats& st) {
+    int tc = (int)floor(shoe.trueCount());
+    tc = max(-SimStats::TRUE_COUNT_MAX, min(SimStats::TRUE_COUNT_MAX, tc));
+    st.trueCounts[tc + SimStats::TRUE_COUNT_MAX]++;
+}
+
+// Chien luoc nguoi choi: tra ve true neu rut them (hit).
+// dealerUp la la bai ngua cua nha cai (la thu hai, la dau bi up).
+bool policyStand(const HandState& /*hand*/, int /*dealerUp*/) { return false; }
+bool policyDealer(const HandState& hand, int /*dealerUp*/) { return hand.value() < 17; }
+bool policyBasic(const HandState& hand, int dealerUp) {
+    // Gan dung basic strategy chi co hit/stand
+    int v = hand.value(), up = rankValue(dealerUp);
+    if (v <= 11) return true;
+    if (v == 12) return up < 4 || up > 6;
+    if (v <= 16) return up >= 7;
+    return false;
 }
 
-int main() {
+// Tra bang chien luoc cua solver, O(1)
+bool policyTable(const HandState& hand, int dealerUp) {
+    int v = hand.value();
+    return v < 21 && strategyHit[v][hand.isSoft()][RANKS.points[dealerUp] - 1];
+}
+
+struct Policy {
+    const char* name;
+    bool (*decide)(const HandState& hand, int dealerUp);
+};
+
+const Policy policies[] = {
+    {"stand", policyStand},
+    {"dealer", policyDealer},
+    {"basic", policyBasic},
+    {"table", policyTable},
+};
+
+// ===== Lich su van choi dang nhi phan =====
+// Moi van la mot ban ghi co dinh 32 byte, ghi/doc bang memcpy, khong can phan
+// tich van ban. File = HandLogHeader + ban ghi thu i cua van thu i.
+// File --record con co ban ghi danh dau phien (REC_SESSION) truoc cac van cua
+// moi phien choi: cac van sau no la cac van lien tiep cua Deck(seed) phien do.
+
+struct HandRecord {
+    uint8_t player[13]; // la nguoi choi theo thu tu rut
+    uint8_t dealer[13]; // dealer[0] la la up, dealer[1] la la ngua, roi cac la rut
+    uint8_t nPlayer;
+    uint8_t nDealer;
+    uint8_t hits;       // so lan nguoi choi rut them
+    int8_t result;      // +1 thang, 0 hoa, -1 thua
+    uint16_t flags;
+};
+static_assert(sizeof(HandRecord) == 32, "HandRecord phai dung 32 byte");
+
+enum HandFlags {
+    REC_PLAYER_BJ = 1,
+    REC_DEALER_BJ = 2,
+    REC_PLAYER_BUST = 4,
+    REC_DEALER_BUST = 8,
+    REC_SESSION = 16,   // khong phai van choi: bat dau phien moi, seed o player[0..7]
+};
+
+const char HAND_LOG_MAGIC[4] = {'B', 'J', 'H', '1'};
+
+struct HandLogHeader {
+    char magic[4];
+    uint32_t recordSize;
+    uint64_t seed;      // seed goc; van i thuoc khoi i / SIM_BLOCK (--record: seed phien dau)
+    uint64_t count;     // chi de tham khao; so ban ghi thuc = (kich thuoc file - header) / 32
+    uint32_t decks;     // 0 = mot bo xao moi van
+    uint32_t source;    // LOG_SIM hoac LOG_INTERACTIVE
+};
+
+enum LogSource { LOG_SIM = 0, LOG_INTERACTIVE = 1 };
+static_assert(sizeof(HandLogHeader) == 32, "HandLogHeader phai dung 32 byte");
+
+HandRecord sessionRecord(uint64_t seed) {
+    HandRecord r{};
+    memcpy(r.player, &seed, sizeof(seed));
+    r.flags = REC_SESSION;
+    return r;
+}
+
+uint64_t sessionSeed(const HandRecord& r) {
+    uint64_t seed;
+    memcpy(&seed, r.player, sizeof(seed));
+    return seed;
+}
+
+// Kiem tra header truoc khi ghi them vao file --record co san: dung magic, kich
+// thuoc ban ghi, nguon tuong tac va file gom tron ban ghi
+bool validRecordFile(FILE* file, long size) {
+    HandLogHeader header;
+    return size >= (long)sizeof(header) &&
+           (size - sizeof(header)) % sizeof(HandRecord) == 0 &&
+           fseek(file, 0, SEEK_SET) == 0 &&
+           fread(&header, sizeof(header), 1, file) == 1 &&
+           memcmp(header.magic, HAND_LOG_MAGIC, 4) == 0 &&
+           header.recordSize == sizeof(HandRecord) &&
+           header.source == LOG_INTERACTIVE;
+}
+
+void recordCard(uint8_t* cards, uint8_t& n, int c) {
+    if (n < 13) cards[n] = (uint8_t)c;
+    if (n < 255) n++;
+}
+
+// Ban ghi cho van choi tuong tac (Hand giu la up o cards[1], la up o cards[0])
+HandRecord makeRecord(const Hand& player, const Hand& dealer, int result) {
+    HandRecord r{};
+    for (int i = 0; i < player.size(); ++i) recordCard(r.player, r.nPlayer, player.cards[i]);
+    recordCard(r.dealer, r.nDealer, dealer.cards[1]);
+    recordCard(r.dealer, r.nDealer, dealer.cards[0]);
+    for (int i = 2; i < dealer.size(); ++i) recordCard(r.dealer, r.nDealer, dealer.cards[i]);
+    bool playerBJ = player.size() == 2 && player.value() == 21;
+    bool dealerBJ = dealer.size() == 2 && dealer.value() == 21;
+    r.hits = (playerBJ || dealerBJ) ? 0 : player.size() - 2;
+    r.result = (int8_t)result;
+    if (playerBJ) r.flags |= REC_PLAYER_BJ;
+    if (dealerBJ) r.flags |= REC_DEALER_BJ;
+    if (player.value() > 21) r.flags |= REC_PLAYER_BUST;
+    if (dealer.value() > 21) r.flags |= REC_DEALER_BUST;
+    return r;
+}
+
+// In mot ban ghi thanh mot dong van ban
+void formatRecord(TextBuffer& out, uint64_t index, const HandRecord& r) {
+    if (r.flags & REC_SESSION) {
+        char seed[24];
+        snprintf(seed, sizeof(seed), "%llu", (unsigned long long)sessionSeed(r));
+        out.write("--- Phien moi, seed "); out.write(seed); out.write(" ---\n");
+        return;
+    }
+    HandState p, d;
+    out.putChar('#'); out.putInt(index);
+    out.write("  Ban:");
+    for (int i = 0; i < r.nPlayer && i < 13; ++i) {
+        out.putChar(' '); out.putCard(r.player[i]); p.add(r.player[i]);
+    }
+    out.write(" ("); out.putInt(p.value()); out.write(")  Nha cai:");
+    for (int i = 0; i < r.nDealer && i < 13; ++i) {
+        out.putChar(' '); out.putCard(r.dealer[i]); d.add(r.dealer[i]);
+    }
+    out.write(" ("); out.putInt(d.value()); out.write(")  ");
+    out.write(r.result > 0 ? "thang" : r.result < 0 ? "thua" : "hoa");
+    out.putChar('\n');
+}
+
+// Choi mot van voi bo bai da xao, cap nhat thong ke. Tra ve +1 / 0 / -1.
+// Source la Deck hoac Shoe: chi can draw()
+template <typename Source, typename Decide>
+int playHand(Source& deck, Decide decide, SimStats& st, HandRecord* rec = nullptr) {
+    HandState player, dealer;
+    int p1 = deck.draw();
+    int hole = deck.draw();
+    int p2 = deck.draw();
+    int up = deck.draw();
+    player.add(p1);
+    player.add(p2);
+    dealer.add(hole);
+    dealer.add(up);
+    st.hands++;
+    if (rec) {
+        *rec = HandRecord{};
+        recordCard(rec->player, rec->nPlayer, p1);
+        recordCard(rec->player, rec->nPlayer, p2);
+        recordCard(rec->dealer, rec->nDealer, up);
+        recordCard(rec->dealer, rec->nDealer, hole);
+    }
+
+    int pVal = player.value();
+    int dVal = dealer.value();
+    int result;
+    uint16_t flags = 0;
+    if (pVal == 21 || dVal == 21) {
+        if (pVal == 21) { st.playerBlackjacks++; flags |= REC_PLAYER_BJ; }
+        if (dVal == 21) { st.dealerBlackjacks++; flags |= REC_DEALER_BJ; }
+        result = (pVal == 21) - (dVal == 21);
+    } else {
+        while (decide(player, up)) {
+            int c = deck.draw();
+            player.add(c);
+            if (rec) { recordCard(rec->player, rec->nPlayer, c); rec->hits++; }
+            pVal = player.value();
+            if (pVal >= 21) break;
+        }
+        if (pVal > 21) {
+            st.playerBusts++;
+            flags |= REC_PLAYER_BUST;
+            result = -1;
+        } else {
+            while (dVal < 17) {
+                int c = deck.draw();
+                dealer.add(c);
+                if (rec) recordCard(rec->dealer, rec->nDealer, c);
+                dVal = dealer.value();
+            }
+            if (dVal > 21) { st.dealerBusts++; flags |= REC_DEALER_BUST; result = 1; }
+            else result = (pVal > dVal) - (pVal < dVal);
+        }
+    }
+    if (result > 0) st.wins++;
+    else if (result < 0) st.losses++;
+    else st.pushes++;
+    st.net += result;
+    st.netSq += result * result;
+    if (rec) { rec->result = (int8_t)result; rec->flags = flags; }
+    return result;
+}
+
+// recs != nullptr: ghi lai tung van vao recs[0..hands)
+template <typename Source, typename Decide>
+void simulate(uint64_t hands, Decide decide, Source& deck, SimStats& st,
+              HandRecord* recs = nullptr) {
+    for (uint64_t i = 0; i < hands; ++i) {
+        deck.reset();
+        noteRound(deck, st);
+        playHand(deck, decide, st, recs ? recs + i : nullptr);
+    }
+}
+
+// ===== Mo phong song song, tai lap duoc =====
+// Cong viec chia thanh cac khoi SIM_BLOCK van. Khoi thu b luon dung luong so
+// ngau nhien rieng sinh tu (seed, b), nen ket qua chi phu thuoc vao seed va
+// so van, khong phu thuoc so thread hay thu tu cac thread lay khoi.
+const uint64_t SIM_BLOCK = 1 << 16;
+
+uint64_t streamSeed(uint64_t seed, uint64_t stream) {
+    return seed ^ splitmix64(stream);
+}
+
+// decks = 0: mot bo 52 la xao lai moi van (giong van choi tuong tac);
+// decks > 0: moi khoi dung mot Shoe moi voi so bo va penetration cho truoc.
+// logFd >= 0: ghi lich su tung van vao file (da co header). Ban ghi co kich
+// thuoc co dinh nen moi khoi pwrite thang vao vi tri cua no, khong can cho
+// cac thread khac.
+template <typename Decide>
+SimStats simulateParallel(uint64_t hands, Decide decide, uint64_t seed, int threads,
+                          int decks = 0, double penetration = 0.75, int logFd = -1) {
+    uint64_t blocks = (hands + SIM_BLOCK - 1) / SIM_BLOCK;
+    atomic<uint64_t> nextBlock(0);
+    vector<SimStats> local(threads); // thong ke rieng tung thread, gop o cuoi
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            SimStats st;
+            vector<HandRecord> recs(logFd >= 0 ? SIM_BLOCK : 0);
+            HandRecord* out = logFd >= 0 ? recs.data() : nullptr;
+            for (uint64_t b; (b = nextBlock++) < blocks;) {
+                uint64_t count = min(SIM_BLOCK, hands - b * SIM_BLOCK);
+                if (decks > 0) {
+                    Shoe shoe(decks, penetration, streamSeed(seed, b));
+                    simulate(count, decide, shoe, st, out);
+                    st.shuffles += shoe.shuffles;
+                } else {
+                    Deck deck(streamSeed(seed, b));
+                    simulate(count, decide, deck, st, out);
+                }
+                if (out) {
+                    off_t offset = sizeof(HandLogHeader) + b * SIM_BLOCK * sizeof(HandRecord);
+                    if (pwrite(logFd, out, count * sizeof(HandRecord), offset) < 0)
+                        perror("pwrite");
+                }
+            }
+            local[t] = st;
+        });
+    }
+    for (thread& w : workers) w.join();
+    SimStats total;
+    for (const SimStats& st : local) total.merge(st);
+    return total;
+}
+
+void printStats(const SimStats& st, double seconds) {
+    double n = st.hands ? (double)st.hands : 1.0;
+    cout << "So van:        " << st.hands << "\n";
+    cout << "Thang / thua / hoa: " << st.wins << " / " << st.losses << " / "
+         << st.pushes << "\n";
+    cout << "Ti le thang:   " << st.wins / n << "  thua: " << st.losses / n
+         << "  hoa: " << st.pushes / n << "\n";
+    cout << "Nguoi choi quac: " << st.playerBusts << "  nha cai quac: "
+         << st.dealerBusts << "\n";
+    cout << "Blackjack nguoi choi / nha cai: " << st.playerBlackjacks << " / "
+         << st.dealerBlackjacks << "\n";
+    double mean = st.net / n;
+    double variance = st.netSq / n - mean * mean;
+    double half = 1.96 * sqrt(variance / n);
+    cout << "Loi nhuan ky vong moi van: " << mean << "  (95% CI: "
+         << mean - half << " .. " << mean + half << ")\n";
+    cout << "Toc do: " << (uint64_t)(st.hands / seconds) << " van/giay ("
+         << seconds << " s)\n";
+}
+
+// Hi-Lo can bang (20 la +1, 20 la -1 moi bo): rut het mot shoe thi running
+// count phai ve 0. Tra ve running count sau khi rut het.
+int hiLoAfterFullShoe(int decks, uint64_t seed) {
+    Shoe shoe(decks, 1.0, seed);
+    for (size_t i = 0; i < shoe.cards.size(); ++i) shoe.draw();
+    return shoe.runningCount;
+}
+
+void printCountStats(const SimStats& st) {
+    double n = st.hands ? (double)st.hands : 1.0;
+    cout << "So lan xao lai shoe: " << st.shuffles << "  (" << st.hands / max<double>(st.shuffles, 1)
+         << " van / lan)\n";
+    cout << "True count Hi-Lo dau van (lam tron xuong):\n";
+    for (int i = 0; i <= 2 * SimStats::TRUE_COUNT_MAX; ++i) {
+        int tc = i - SimStats::TRUE_COUNT_MAX;
+        const char* edge = tc == -SimStats::TRUE_COUNT_MAX ? "<=" : tc == SimStats::TRUE_COUNT_MAX ? ">=" : "  ";
+        cout << "  " << edge << (tc > 0 ? "+" : tc == 0 ? " " : "") << tc << ": "
+             << st.trueCounts[i] / n * 100 << "%\n";
+    }
+}
+
+// ./program --sim <so van> [stand|dealer|basic|table] [--threads T] [--seed S]
+//                            [--decks D] [--pen P] [--log file]
+int runSimulation(int argc, char* argv[]) {
+    uint64_t hands = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1000000;
+    const Policy* policy = &policies[2];
+    int threads = hardwareThreads();
+    uint64_t seed = clockSeed();
+    int decks = 0;
+    double penetration = 0.75;
+    const char* logPath = nullptr;
+    for (int i = 3; i < argc; ++i) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--decks") == 0 && i + 1 < argc) {
+            decks = max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--pen") == 0 && i + 1 < argc) {
+            penetration = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            logPath = argv[++i];
+        } else {
+            policy = nullptr;
+            for (const Policy& p : policies)
+                if (strcmp(p.name, argv[i]) == 0) policy = &p;
+            if (!policy) { cout << "Chien luoc khong hop le: " << argv[i] << "\n"; return 1; }
+        }
+    }
+
+    if (policy->decide == policyTable) {
+        BlackjackSolver solver;
+        solver.solve();
+    }
+
+    int logFd = -1;
+    if (logPath) {
+        logFd = open(logPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (logFd < 0) { perror(logPath); return 1; }
+        HandLogHeader header{};
+        memcpy(header.magic, HAND_LOG_MAGIC, 4);
+        header.recordSize = sizeof(HandRecord);
+        header.seed = seed;
+        header.count = hands;
+        header.decks = decks;
+        if (pwrite(logFd, &header, sizeof(header), 0) != sizeof(header)) {
+            perror(logPath);
+            return 1;
+        }
+    }
+
+    auto start = chrono::steady_clock::now();
+    SimStats st = simulateParallel(hands, policy->decide, seed, threads, decks, penetration, logFd);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (logFd >= 0) close(logFd);
+
+    cout << "=== Mo phong Xi Dach: chien luoc " << policy->name << " ===\n";
+    cout << "Seed: " << seed << "  threads: " << threads << "\n";
+    if (decks > 0)
+        cout << "Shoe: " << decks << " bo, penetration " << penetration << "\n";
+    printStats(st, seconds);
+    if (decks > 0) {
+        printCountStats(st);
+        int balance = hiLoAfterFullShoe(decks, seed);
+        cout << "Hi-Lo sau ca shoe: " << balance << (balance == 0 ? " (dung)\n" : " (SAI)\n");
+        if (balance != 0) return 1;
+    }
+    return 0;
+}
+
+// ===== Phan tich lich su =====
+// File lich su duoc mmap (chi doc, tuan tu) nen khong phai nap het vao RAM.
+// Cac ban ghi chia thanh doan lien tiep cho tung thread; moi thread cong don
+// vao bang thong ke rieng, cuoi cung gop lai.
+
+struct MappedLog {
+    const HandLogHeader* header = nullptr;
+    const HandRecord* records = nullptr;
+    uint64_t count = 0;
+    void* addr = nullptr;
+    size_t length = 0;
+
+    ~MappedLog() { if (addr) munmap(addr, length); }
+    bool open(const char* path) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(HandLogHeader)) {
+            close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+        addr = p;
+        length = st.st_size;
+        header = (const HandLogHeader*)p;
+        if (memcmp(header->magic, HAND_LOG_MAGIC, 4) != 0 ||
+            header->recordSize != sizeof(HandRecord))
+            return false;
+        records = (const HandRecord*)((const char*)p + sizeof(HandLogHeader));
+        count = (length - sizeof(HandLogHeader)) / sizeof(HandRecord);
+        madvise(p, length, MADV_SEQUENTIAL);
+        return true;
+    }
+};
+
+// Tinh huong = (tong 2 la dau cua nguoi choi, mem/cung, la up nha cai,
+// hanh dong dau tien: 0 dung, 1 rut)
+struct SituationStats {
+    uint64_t hands, wins, losses, pushes;
+};
+
+struct LogAnalysis {
+    SituationStats cell[22][2][10][2] = {};
+    SimStats total;
+
+    void add(const HandRecord& r) {
+        if (r.flags & REC_SESSION) return;
+        // van ket thuc bang Blackjack tu nhien khong co quyet dinh nao
+        if (!(r.flags & (REC_PLAYER_BJ | REC_DEALER_BJ))) {
+            HandState p;
+            p.add(r.player[0]);
+            p.add(r.player[1]);
+            int up = RANKS.points[r.dealer[0]] - 1;
+            SituationStats& c = cell[p.value()][p.isSoft()][up][r.hits > 0];
+            c.hands++;
+            if (r.result > 0) c.wins++;
+            else if (r.result < 0) c.losses++;
+            else c.pushes++;
+        }
+
+        total.hands++;
+        if (r.result > 0) total.wins++;
+        else if (r.result < 0) total.losses++;
+        else total.pushes++;
+        total.net += r.result;
+        total.netSq += r.result * r.result;
+        if (r.flags & REC_PLAYER_BJ) total.playerBlackjacks++;
+        if (r.flags & REC_DEALER_BJ) total.dealerBlackjacks++;
+        if (r.flags & REC_PLAYER_BUST) total.playerBusts++;
+        if (r.flags & REC_DEALER_BUST) total.dealerBusts++;
+    }
+    void merge(const LogAnalysis& o) {
+        for (int v = 0; v < 22; ++v)
+            for (int s = 0; s < 2; ++s)
+                for (int u = 0; u < 10; ++u)
+                    for (int a = 0; a < 2; ++a) {
+                        SituationStats& c = cell[v][s][u][a];
+                        const SituationStats& d = o.cell[v][s][u][a];
+                        c.hands += d.hands; c.wins += d.wins;
+                        c.losses += d.losses; c.pushes += d.pushes;
+                    }
+        total.merge(o.total);
+    }
+};
+
+// ./program --analyze <file> [--threads T]
+int analyzeLog(int argc, char* argv[]) {
+    MappedLog log;
+    if (argc < 3 || !log.open(argv[2])) { cout << "Khong doc duoc file lich su\n"; return 1; }
+    int threads = hardwareThreads();
+    if (argc > 4 && strcmp(argv[3], "--threads") == 0) threads = max(1, atoi(argv[4]));
+
+    auto start = chrono::steady_clock::now();
+    vector<LogAnalysis> local(threads); // ~14 KB moi thread
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            uint64_t lo = log.count * t / threads, hi = log.count * (t + 1) / threads;
+            for (uint64_t i = lo; i < hi; ++i) local[t].add(log.records[i]);
+        });
+    }
+    for (thread& w : workers) w.join();
+    LogAnalysis all = local[0];
+    for (int t = 1; t < threads; ++t) all.merge(local[t]);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    const char* upNames[] = {"A", "2", "3", "4", "5", "6", "7", "8", "9", "10"};
+    TextBuffer out;
+    out.write("=== Ti le thang theo tinh huong (2 la dau, la up, hanh dong dau tien) ===\n");
+    out.write("(khong tinh cac van ket thuc bang Blackjack tu nhien)\n");
+    for (int s = 0; s < 2; ++s)
+        for (int v = 4; v <= 21; ++v)
+            for (int u = 0; u < 10; ++u)
+                for (int a = 0; a < 2; ++a) {
+                    const SituationStats& c = all.cell[v][s][u][a];
+                    if (!c.hands) continue;
+                    out.write(s ? "mem " : "cung "); out.putInt(v);
+                    out.write(" vs "); out.write(upNames[u]);
+                    out.write(a ? "  rut " : "  dung");
+                    out.write("  van="); out.putInt(c.hands);
+                    out.write("  thang="); out.putPercent(c.wins, c.hands);
+                    out.write("  thua="); out.putPercent(c.losses, c.hands);
+                    out.write("  EV="); out.putPercent((int64_t)c.wins - (int64_t)c.losses, c.hands);
+                    out.putChar('\n');
+                }
+    out.flush();
+    cout << "=== Tong hop: " << argv[2] << " (seed " << log.header->seed << ") ===\n";
+    printStats(all.total, seconds);
+    return 0;
+}
+
+// ./program --print-log <file> [so van]: doi lich su nhi phan ra van ban
+int printLog(int argc, char* argv[]) {
+    FILE* file = argc > 2 ? fopen(argv[2], "rb") : nullptr;
+    if (!file) { cout << "Khong mo duoc file lich su\n"; return 1; }
+    HandLogHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, HAND_LOG_MAGIC, 4) != 0 ||
+        header.recordSize != sizeof(HandRecord)) {
+        cout << "File lich su khong hop le\n";
+        fclose(file);
+        return 1;
+    }
+    uint64_t limit = argc > 3 ? strtoull(argv[3], nullptr, 10) : UINT64_MAX;
+
+    cout.flush();
+    TextBuffer out;
+    vector<HandRecord> chunk(4096);
+    uint64_t index = 0;
+    while (index < limit) {
+        size_t want = (size_t)min<uint64_t>(chunk.size(), limit - index);
+        size_t got = fread(chunk.data(), sizeof(HandRecord), want, file);
+        if (got == 0) break;
+        for (size_t i = 0; i < got; ++i) formatRecord(out, index + i, chunk[i]);
+        index += got;
+    }
+    fclose(file);
+    return 0;
+}
+
+// ./program --solve: in phan bo tong cuoi cua nha cai, bang chien luoc va EV
+int runSolver() {
+    auto start = chrono::steady_clock::now();
+    BlackjackSolver solver;
+    solver.solve();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    const char* upNames[] = {"A", "2", "3", "4", "5", "6", "7", "8", "9", "10"};
+    cout << "=== Phan bo tong cuoi cua nha cai (biet khong co Blackjack) ===\n";
+    cout << "up      17      18      19      20      21    quac\n";
+    cout.setf(ios::fixed);
+    cout.precision(4);
+    for (int up = 0; up < 10; ++up) {
+        Composition c = BlackjackSolver::fullDeck();
+        c.take(up);
+        BlackjackSolver::DealerDist d = solver.dealerGivenUp(c, up);
+        cout << upNames[up] << (up == 9 ? " " : "  ");
+        for (double x : d) cout << "  " << x;
+        cout << "\n";
+    }
+
+    cout << "=== Bang chien luoc (H = rut, S = dung) ===\n";
+    cout << "tong     2  3  4  5  6  7  8  9 10  A\n";
+    for (int soft = 0; soft < 2; ++soft) {
+        for (int v = soft ? 13 : 5; v <= 20; ++v) {
+            cout << (soft ? "mem " : "cung") << (v < 10 ? "  " : " ") << v;
+            for (int i = 1; i <= 10; ++i) {
+                int up = i % 10; // 2..10 roi A
+                cout << "  " << (strategyHit[v][soft][up] ? 'H' : 'S');
+            }
+            cout << "\n";
+        }
+    }
+    cout << "EV khi choi toi uu (theo thanh phan bo bai): " << solver.gameEV << "\n";
+    cout << "So trang thai: nha cai " << solver.dealerMemo.size() << ", nguoi choi "
+         << solver.playerMemo.size() << "  (" << seconds << " s)\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
+    if (argc > 1 && strcmp(argv[1], "--sim") == 0)
+        return runSimulation(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "--solve") == 0)
+        return runSolver();
+    if (argc > 1 && strcmp(argv[1], "--print-log") == 0)
+        return printLog(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "--analyze") == 0)
+        return analyzeLog(argc, argv);
+
+    // ./program --record <file>: ghi them tung van vao file lich su, moi phien
+    // mo dau bang ban ghi REC_SESSION chua seed de choi lai duoc
+    uint64_t seed = clockSeed();
+    FILE* record = nullptr;
+    if (argc > 2 && strcmp(argv[1], "--record") == 0) {
+        record = fopen(argv[2], "a+b");
+        if (!record) { perror(argv[2]); return 1; }
+        fseek(record, 0, SEEK_END);
+        long size = ftell(record);
+        if (size == 0) {
+            HandLogHeader header{};
+            memcpy(header.magic, HAND_LOG_MAGIC, 4);
+            header.recordSize = sizeof(HandRecord);
+            header.seed = seed;
+            header.source = LOG_INTERACTIVE;
+            fwrite(&header, sizeof(header), 1, record);
+        } else if (!validRecordFile(record, size)) {
+            cout << "File lich su khong hop le: " << argv[2] << "\n";
+            fclose(record);
+            return 1;
+        }
+        fseek(record, 0, SEEK_END);
+        HandRecord marker = sessionRecord(seed);
+        fwrite(&marker, sizeof(marker), 1, record);
+        fflush(record);
+    }
+
     cout << "=== Tro choi Xi Dach (Blackjack) ===\n";
+    Deck deck(seed);
     while (true) {
-        Deck deck; deck.reset();
-        vector<int> player, dealer;
+        deck.reset();
+        Hand player, dealer;
 
         // chia 2 lá đầu
-        player.push_back(deck.draw());
-        dealer.push_back(deck.draw());
-        player.push_back(deck.draw());
-        dealer.push_back(deck.draw());
+        player.add(deck.draw());
+        dealer.add(deck.draw());
+        player.add(deck.draw());
+        dealer.add(deck.draw());
 
         cout << "Bai cua ban: "; printHand(player); 
-        cout << "  (tong=" << handValue(player) << ")\n";
+        cout << "  (tong=" << player.value() << ")\n";
         cout << "Bai nha cai: "; printHand(dealer, true); cout << "\n";
 
-        int pVal = handValue(player);
-        int dVal = handValue(dealer);
+        int pVal = player.value();
+        int dVal = dealer.value();
+        int result = 0;
 
         // Blackjack tự nhiên
         if (pVal == 21 || dVal == 21) {
             cout << "--- Kiem tra Blackjack ---\n";
             cout << "Bai nha cai: "; printHand(dealer, false);
             cout << "  (tong=" << dVal << ")\n";
+            result = (pVal == 21) - (dVal == 21);
             if (pVal == 21 && dVal == 21)      cout << "Hoa (push). Ca hai deu Blackjack!\n";
             else if (pVal == 21)               cout << "Ban thang voi Blackjack!\n";
             else                                cout << "Nha cai co Blackjack. Ban thua.\n";
@@ -130,15 +1174,15 @@ int main() {
             // Lượt người chơi
             while (true) {
                 cout << "Ban chon (h = rut, s = dung): ";
-                char act; if (!(cin >> act)) return 0;
+                char act; if (!(cin >> act)) { if (record) fclose(record); return 0; }
                 if (act == 'h' || act == 'H') {
                     int c = deck.draw();
-                    player.push_back(c);
-                    pVal = handValue(player);
-                    cout << "Ban rut: " << cardToString(c) << "\n";
+                    player.add(c);
+                    pVal = player.value();
+                    cout << "Ban rut: "; printCard(c); cout << "\n";
                     cout << "Bai cua ban: "; printHand(player);
                     cout << "  (tong=" << pVal << ")\n";
-                    if (pVal > 21) { cout << "Ban QUAC (>21). Ban thua.\n"; break; }
+                    if (pVal > 21) { cout << "Ban QUAC (>21). Ban thua.\n"; result = -1; break; }
                     if (pVal == 21) { cout << "Ban dat 21!\n"; break; }
                 } else if (act == 's' || act == 'S') {
                     cout << "Ban dung.\n"; break;
@@ -154,14 +1198,16 @@ int main() {
                 cout << "  (tong=" << dVal << ")\n";
                 while (dVal < 17) {
                     int c = deck.draw();
-                    dealer.push_back(c);
-                    dVal = handValue(dealer);
-                    cout << "Nha cai rut: " << cardToString(c) 
-                         << "  -> tong=" << dVal << "\n";
+                    dealer.add(c);
+                    dVal = dealer.value();
+                    cout << "Nha cai rut: "; printCard(c);
+                    cout << "  -> tong=" << dVal << "\n";
                 }
                 if (dVal > 21) {
                     cout << "Nha cai QUAC (>21). Ban thang!\n";
+                    result = 1;
                 } else {
+                    result = (pVal > dVal) - (pVal < dVal);
                     cout << "--- Ket qua ---\n";
                     cout << "Ban: " << pVal << "  vs  Nha cai: " << dVal << "\n";
                     if (pVal > dVal)      cout << "Ban thang!\n";
@@ -171,11 +1217,18 @@ int main() {
             }
         }
 
+        if (record) {
+            HandRecord r = makeRecord(player, dealer, result);
+            fwrite(&r, sizeof(r), 1, record);
+            fflush(record);
+        }
+
         cout << "Choi van moi? (y/n): ";
         char again; if (!(cin >> again)) break;
         if (again != 'y' && again != 'Y') break;
     }
 
+    if (record) fclose(record);
     cout << "Cam on da choi!\n";
     return 0;
 }